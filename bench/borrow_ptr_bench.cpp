@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "../borrow_ptr.h"
+#include "../shared_ptr.h"
+
+namespace
+{
+
+struct Counter
+{
+  std::int64_t value = 0;
+};
+
+// Callees are kept out of line so every call really passes its argument.
+[[gnu::noinline]] void BumpByValue(smrtptrs::shared_ptr<Counter> counter)
+{
+  ++counter->value;
+}
+
+[[gnu::noinline]] void BumpByConstRef(const smrtptrs::shared_ptr<Counter>& counter)
+{
+  ++counter->value;
+}
+
+[[gnu::noinline]] void BumpBorrowed(smrtptrs::borrow_ptr<Counter> counter)
+{
+  ++counter->value;
+}
+
+}  // namespace
+
+static void BM_Call_SharedPtrByValue(benchmark::State& state)
+{
+  auto counter = smrtptrs::make_shared<Counter>();
+  for (auto _ : state)
+  {
+    BumpByValue(counter);
+  }
+  benchmark::DoNotOptimize(counter->value);
+}
+
+static void BM_Call_SharedPtrByConstRef(benchmark::State& state)
+{
+  auto counter = smrtptrs::make_shared<Counter>();
+  for (auto _ : state)
+  {
+    BumpByConstRef(counter);
+  }
+  benchmark::DoNotOptimize(counter->value);
+}
+
+static void BM_Call_BorrowPtr(benchmark::State& state)
+{
+  auto counter = smrtptrs::make_shared<Counter>();
+  for (auto _ : state)
+  {
+    BumpBorrowed(counter);
+  }
+  benchmark::DoNotOptimize(counter->value);
+}
+
+BENCHMARK(BM_Call_SharedPtrByValue);
+BENCHMARK(BM_Call_SharedPtrByConstRef);
+BENCHMARK(BM_Call_BorrowPtr);
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "../shared_ptr.h"
+
+namespace
+{
+
+struct Packed
+{
+  std::int64_t value;
+};
+
+struct Isolated
+{
+  std::int64_t value;
+};
+
+}  // namespace
+
+template <>
+struct smrtptrs::cache_isolated<Isolated> : std::true_type
+{
+};
+
+constexpr int max_threads = 64;
+
+// The objects are created first and adopted afterwards, so the control
+// blocks come from back-to-back allocations, as they do for objects that
+// are set up together.
+template <typename T>
+static std::vector<smrtptrs::shared_ptr<T>>& Objects()
+{
+  static std::vector<smrtptrs::shared_ptr<T>> objects;
+  if (objects.empty())
+  {
+    std::vector<T*> raw;
+    for (int i = 0; i < max_threads; ++i)
+    {
+      raw.push_back(new T{i});
+    }
+    for (T* p : raw)
+    {
+      objects.emplace_back(p);
+    }
+  }
+  return objects;
+}
+
+// Every thread copies and drops owners of its own object; nothing is shared
+// but the cache lines the control blocks happen to sit on.
+template <typename T>
+static void BM_IndependentCopies(benchmark::State& state)
+{
+  const auto& mine = Objects<T>()[state.thread_index()];
+  for (auto _ : state)
+  {
+    smrtptrs::shared_ptr<T> copy(mine);
+    benchmark::DoNotOptimize(copy);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_IndependentCopies<Packed>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_IndependentCopies<Isolated>)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Compares the full rebuild time of a synthetic many-TU project that
+# includes the headers with one that imports the smrtptrs module.
+#
+# Usage: bench/compile_time/run.sh [tu-count] [build-dir]
+set -e
+
+SOURCE_DIR="$(cd "$(dirname "$0")" && pwd)"
+TU_COUNT="${1:-200}"
+BUILD_DIR="${2:-${SOURCE_DIR}/../../_compile_time_build}"
+JOBS="$(nproc)"
+
+cmake -S "${SOURCE_DIR}" -B "${BUILD_DIR}" -DSMRTPTRS_TU_COUNT="${TU_COUNT}" > /dev/null
+
+TARGETS=(tu_headers)
+if cmake --build "${BUILD_DIR}" --target help 2> /dev/null | grep -q tu_module; then
+  TARGETS+=(tu_module)
+fi
+
+for target in "${TARGETS[@]}"; do
+  cmake --build "${BUILD_DIR}" --target clean > /dev/null
+  start=$(date +%s.%N)
+  cmake --build "${BUILD_DIR}" --target "${target}" -j "${JOBS}" > /dev/null
+  end=$(date +%s.%N)
+  awk -v t="${target}" -v n="${TU_COUNT}" -v s="${start}" -v e="${end}" \
+    'BEGIN { printf "%-16s %4d TUs  %8.2f s\n", t, n, e - s }'
+done
@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "../shared_ptr.h"
+#include "../test/alloc_counter.h"
+
+namespace
+{
+
+struct Node
+{
+  static inline std::int64_t alive = 0;
+
+  smrtptrs::shared_ptr<Node> next;
+  char payload[64];
+
+  Node()
+  {
+    ++alive;
+  }
+
+  ~Node()
+  {
+    --alive;
+  }
+};
+
+}  // namespace
+
+template <>
+struct smrtptrs::cycle_edges<Node>
+{
+  template <typename F>
+  static void for_each(Node& node, F&& visit)
+  {
+    visit(node.next);
+  }
+};
+
+constexpr std::int64_t ring_length = 4;
+
+// Drops `rings` rings of ring_length nodes; without collection every one of
+// them leaks.
+static void MakeGarbage(std::int64_t rings)
+{
+  for (std::int64_t r = 0; r < rings; ++r)
+  {
+    auto first = smrtptrs::make_shared<Node>();
+    auto last = first;
+    for (std::int64_t i = 1; i < ring_length; ++i)
+    {
+      last->next = smrtptrs::make_shared<Node>();
+      last = last->next;
+    }
+    last->next = first;
+  }
+}
+
+// Full collection of a batch of garbage rings; reports the bytes that would
+// have leaked and the share of the nodes collect_cycles() destroyed.
+static void BM_CollectAll(benchmark::State& state)
+{
+  const std::int64_t rings = state.range(0);
+  std::size_t leaked = 0;
+  std::int64_t garbage = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    AllocScope made;
+    MakeGarbage(rings);
+    leaked = made.bytes();
+    garbage = Node::alive;
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(smrtptrs::collect_cycles());
+  }
+  state.counters["leaked_bytes"] = static_cast<double>(leaked);
+  state.counters["reclaimed_fraction"] = 1.0 - static_cast<double>(Node::alive) / static_cast<double>(garbage);
+  state.SetItemsProcessed(state.iterations() * rings * ring_length);
+}
+
+// One bounded step, the pause a request thread would see, for a given
+// budget of traced objects.
+static void BM_CollectStep(benchmark::State& state)
+{
+  const auto budget = static_cast<std::size_t>(state.range(0));
+  std::size_t reclaimed = 0;
+  std::int64_t steps = 0;
+  for (auto _ : state)
+  {
+    if (smrtptrs::pending_cycle_roots() == 0)
+    {
+      state.PauseTiming();
+      MakeGarbage(1 << 12);
+      state.ResumeTiming();
+    }
+    reclaimed += smrtptrs::collect_cycles_step(budget);
+    ++steps;
+  }
+  smrtptrs::collect_cycles();
+  state.counters["reclaimed_per_step"] = static_cast<double>(reclaimed) / static_cast<double>(steps);
+}
+
+BENCHMARK(BM_CollectAll)->Arg(1 << 10)->Arg(1 << 14);
+BENCHMARK(BM_CollectStep)->Arg(16)->Arg(256)->Arg(4096);
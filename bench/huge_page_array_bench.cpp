@@ -0,0 +1,63 @@
+#include "../huge_page_array.h"
+
+#include <benchmark/benchmark.h>
+
+#include "../shared_ptr.h"
+#include "../unique_ptr.h"
+
+// Time from requesting a value-initialized array of range(0) MiB until it is
+// ready, followed by one pass over it, as a service would do at startup.
+
+static std::size_t elements(const benchmark::State& state)
+{
+  return static_cast<std::size_t>(state.range(0)) * (1 << 20) / sizeof(double);
+}
+
+static void BM_MakeUnique_Array(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    auto arr = smrtptrs::make_unique<double[]>(elements(state));
+    arr[elements(state) - 1] = 1.0;
+    benchmark::DoNotOptimize(arr.get());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * (1 << 20));
+}
+
+static void BM_MakeUniqueHuge_Array(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    auto arr = smrtptrs::make_unique_huge<double[]>(elements(state), static_cast<unsigned>(state.range(1)));
+    arr[elements(state) - 1] = 1.0;
+    benchmark::DoNotOptimize(arr.get());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * (1 << 20));
+}
+
+static void BM_MakeShared_Array(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    auto arr = smrtptrs::make_shared<double[]>(elements(state));
+    arr[elements(state) - 1] = 1.0;
+    benchmark::DoNotOptimize(arr.get());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * (1 << 20));
+}
+
+static void BM_MakeSharedHuge_Array(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    auto arr = smrtptrs::make_shared_huge<double[]>(elements(state), static_cast<unsigned>(state.range(1)));
+    arr[elements(state) - 1] = 1.0;
+    benchmark::DoNotOptimize(arr.get());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * (1 << 20));
+}
+
+BENCHMARK(BM_MakeUnique_Array)->Arg(64)->Arg(512)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MakeUniqueHuge_Array)->ArgsProduct({{64, 512}, {1, 4, 0}})->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MakeShared_Array)->Arg(64)->Arg(512)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_MakeSharedHuge_Array)->ArgsProduct({{64, 512}, {1, 4, 0}})->Unit(benchmark::kMillisecond)->UseRealTime();
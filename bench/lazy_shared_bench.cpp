@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "../lazy_shared.h"
+#include "../shared_ptr.h"
+
+namespace
+{
+
+// A component whose construction does real work, e.g. building tables.
+struct Component
+{
+  std::vector<std::uint64_t> table;
+
+  explicit Component(std::size_t size) : table(size)
+  {
+    std::iota(table.begin(), table.end(), std::uint64_t{1});
+  }
+};
+
+constexpr std::size_t table_size = 16 * 1024;
+
+}  // namespace
+
+// Registers range(0) components and uses every tenth one, building all of
+// them at registration.
+static void BM_Startup_Eager(benchmark::State& state)
+{
+  const auto components = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state)
+  {
+    std::vector<smrtptrs::shared_ptr<Component>> registry;
+    registry.reserve(components);
+    for (std::size_t i = 0; i < components; ++i)
+    {
+      registry.push_back(smrtptrs::make_shared<Component>(table_size));
+    }
+    for (std::size_t i = 0; i < components; i += 10)
+    {
+      benchmark::DoNotOptimize(registry[i]->table.back());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The same with lazy_shared: only the used components are built.
+static void BM_Startup_Lazy(benchmark::State& state)
+{
+  const auto components = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state)
+  {
+    std::vector<smrtptrs::lazy_shared<Component>> registry;
+    registry.reserve(components);
+    for (std::size_t i = 0; i < components; ++i)
+    {
+      registry.push_back(smrtptrs::make_lazy_shared<Component>(table_size));
+    }
+    for (std::size_t i = 0; i < components; i += 10)
+    {
+      benchmark::DoNotOptimize(registry[i]->table.back());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Access once built: shared_ptr dereference against the lazy_shared fast path.
+static void BM_Access_SharedPtr(benchmark::State& state)
+{
+  auto ptr = smrtptrs::make_shared<Component>(1);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(ptr->table.data());
+  }
+}
+
+static void BM_Access_LazyShared(benchmark::State& state)
+{
+  auto lazy = smrtptrs::make_lazy_shared<Component>(1);
+  lazy.get();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(lazy->table.data());
+  }
+}
+
+BENCHMARK(BM_Startup_Eager)->Arg(100)->Arg(500);
+BENCHMARK(BM_Startup_Lazy)->Arg(100)->Arg(500);
+BENCHMARK(BM_Access_SharedPtr);
+BENCHMARK(BM_Access_LazyShared);
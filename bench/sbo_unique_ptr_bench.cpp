@@ -0,0 +1,128 @@
+#include "../sbo_unique_ptr.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../unique_ptr.h"
+
+namespace
+{
+
+struct Shape
+{
+  virtual ~Shape() = default;
+  virtual double area() const = 0;
+};
+
+struct Rect : Shape
+{
+  double w, h;
+
+  Rect(double w_, double h_) : w(w_), h(h_) {}
+
+  double area() const override
+  {
+    return w * h;
+  }
+};
+
+struct Circle : Shape
+{
+  double r;
+
+  explicit Circle(double r_) : r(r_) {}
+
+  double area() const override
+  {
+    return 3.14159 * r * r;
+  }
+};
+
+template <typename Ptr, typename Make>
+std::vector<Ptr> build(std::int64_t n, Make make)
+{
+  std::vector<Ptr> shapes;
+  shapes.reserve(n);
+  for (std::int64_t i = 0; i < n; ++i)
+  {
+    shapes.push_back(make(i));
+  }
+  return shapes;
+}
+
+auto make_heap = [](std::int64_t i) -> smrtptrs::unique_ptr<Shape>
+{
+  if (i % 2)
+  {
+    return smrtptrs::unique_ptr<Shape>(new Rect(1.0, static_cast<double>(i)));
+  }
+  return smrtptrs::unique_ptr<Shape>(new Circle(static_cast<double>(i)));
+};
+
+auto make_sbo = [](std::int64_t i) -> smrtptrs::sbo_unique_ptr<Shape>
+{
+  if (i % 2)
+  {
+    return smrtptrs::make_sbo_unique<Shape, Rect>(1.0, static_cast<double>(i));
+  }
+  return smrtptrs::make_sbo_unique<Shape, Circle>(static_cast<double>(i));
+};
+
+template <typename Ptr>
+double total_area(const std::vector<Ptr>& shapes)
+{
+  double sum = 0;
+  for (const auto& shape : shapes)
+  {
+    sum += shape->area();
+  }
+  return sum;
+}
+
+}  // namespace
+
+static void BM_UniquePtr_Construct(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    auto shapes = build<smrtptrs::unique_ptr<Shape>>(state.range(0), make_heap);
+    benchmark::DoNotOptimize(shapes.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SboUniquePtr_Construct(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    auto shapes = build<smrtptrs::sbo_unique_ptr<Shape>>(state.range(0), make_sbo);
+    benchmark::DoNotOptimize(shapes.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_UniquePtr_VirtualTraverse(benchmark::State& state)
+{
+  auto shapes = build<smrtptrs::unique_ptr<Shape>>(state.range(0), make_heap);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(total_area(shapes));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SboUniquePtr_VirtualTraverse(benchmark::State& state)
+{
+  auto shapes = build<smrtptrs::sbo_unique_ptr<Shape>>(state.range(0), make_sbo);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(total_area(shapes));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_UniquePtr_Construct)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SboUniquePtr_Construct)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_UniquePtr_VirtualTraverse)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SboUniquePtr_VirtualTraverse)->Range(1 << 10, 1 << 20);
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../shared_ptr.h"
+
+static void BM_FanOut_Copies(benchmark::State& state)
+{
+  auto ptr = smrtptrs::make_shared<int>(42);
+  std::vector<smrtptrs::shared_ptr<int>> owners;
+  owners.reserve(state.range(0));
+  for (auto _ : state)
+  {
+    for (std::int64_t i = 0; i < state.range(0); ++i)
+    {
+      owners.push_back(ptr);
+    }
+    benchmark::DoNotOptimize(owners.data());
+    owners.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_FanOut_ShareN(benchmark::State& state)
+{
+  auto ptr = smrtptrs::make_shared<int>(42);
+  std::vector<smrtptrs::shared_ptr<int>> owners;
+  owners.reserve(state.range(0));
+  for (auto _ : state)
+  {
+    ptr.share_n(state.range(0), std::back_inserter(owners));
+    benchmark::DoNotOptimize(owners.data());
+    smrtptrs::release_all(std::span(owners));
+    owners.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Teardown of a vector holding range(0) owners spread over range(1) objects.
+static std::vector<smrtptrs::shared_ptr<int>> duplicates(std::int64_t owners, std::int64_t objects)
+{
+  std::vector<smrtptrs::shared_ptr<int>> ptrs;
+  std::vector<smrtptrs::shared_ptr<int>> result;
+  for (std::int64_t i = 0; i < objects; ++i)
+  {
+    ptrs.push_back(smrtptrs::make_shared<int>(static_cast<int>(i)));
+  }
+  for (std::int64_t i = 0; i < owners; ++i)
+  {
+    result.push_back(ptrs[i % objects]);
+  }
+  return result;
+}
+
+static void BM_Teardown_Clear(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto owners = duplicates(state.range(0), state.range(1));
+    state.ResumeTiming();
+    owners.clear();
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Teardown_ReleaseAll(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto owners = duplicates(state.range(0), state.range(1));
+    state.ResumeTiming();
+    smrtptrs::release_all(std::span(owners));
+    owners.clear();
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_FanOut_Copies)->Range(8, 1 << 12);
+BENCHMARK(BM_FanOut_ShareN)->Range(8, 1 << 12);
+BENCHMARK(BM_Teardown_Clear)->Ranges({{1 << 10, 1 << 16}, {1, 64}});
+BENCHMARK(BM_Teardown_ReleaseAll)->Ranges({{1 << 10, 1 << 16}, {1, 64}});
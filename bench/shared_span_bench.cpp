@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../shared_span.h"
+#include "../test/alloc_counter.h"
+
+namespace
+{
+
+constexpr std::size_t receive_size = 64 * 1024;
+
+// A received buffer holding frames of a 2-byte length prefix and a payload
+// of mean_frame bytes on average.
+smrtptrs::shared_buffer Receive(std::size_t mean_frame)
+{
+  auto buffer = smrtptrs::make_shared_buffer(receive_size);
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<std::size_t> length(mean_frame / 2, mean_frame * 3 / 2);
+  std::size_t at = 0;
+  while (at + 2 + mean_frame * 3 / 2 <= receive_size)
+  {
+    auto n = static_cast<std::uint16_t>(length(rng));
+    std::memcpy(buffer.data() + at, &n, 2);
+    at += 2 + n;
+  }
+  return buffer.slice(0, at);
+}
+
+template <typename Frame, typename MakeFrame>
+void Split(const smrtptrs::shared_buffer& received, std::vector<Frame>& frames, MakeFrame make_frame)
+{
+  std::size_t at = 0;
+  while (at < received.size())
+  {
+    std::uint16_t n;
+    std::memcpy(&n, received.data() + at, 2);
+    frames.push_back(make_frame(at + 2, n));
+    at += 2 + n;
+  }
+}
+
+}  // namespace
+
+// Today's framing: every frame copied into its own shared_ptr<char[]>.
+static void BM_Framing_CopyPerFrame(benchmark::State& state)
+{
+  auto received = Receive(static_cast<std::size_t>(state.range(0)));
+  std::vector<smrtptrs::shared_ptr<char[]>> frames;
+  std::size_t allocations = 0;
+  std::size_t copied = 0;
+  for (auto _ : state)
+  {
+    AllocScope scope;
+    copied = 0;
+    Split(received, frames,
+          [&](std::size_t offset, std::size_t n)
+          {
+            auto frame = smrtptrs::make_shared<char[]>(n);
+            std::memcpy(frame.get(), received.data() + offset, n);
+            copied += n;
+            return frame;
+          });
+    allocations = scope.allocations();
+    benchmark::DoNotOptimize(frames.data());
+    frames.clear();
+  }
+  state.counters["allocations"] = static_cast<double>(allocations);
+  state.counters["bytes_copied"] = static_cast<double>(copied);
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(received.size()));
+}
+
+// Frames as slices of the received buffer.
+static void BM_Framing_Slice(benchmark::State& state)
+{
+  auto received = Receive(static_cast<std::size_t>(state.range(0)));
+  std::vector<smrtptrs::shared_buffer> frames;
+  std::size_t allocations = 0;
+  for (auto _ : state)
+  {
+    AllocScope scope;
+    Split(received, frames, [&](std::size_t offset, std::size_t n) { return received.slice(offset, n); });
+    allocations = scope.allocations();
+    benchmark::DoNotOptimize(frames.data());
+    frames.clear();
+  }
+  state.counters["allocations"] = static_cast<double>(allocations);
+  state.counters["bytes_copied"] = 0;
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(received.size()));
+}
+
+BENCHMARK(BM_Framing_CopyPerFrame)->Arg(64)->Arg(512)->Arg(1400);
+BENCHMARK(BM_Framing_Slice)->Arg(64)->Arg(512)->Arg(1400);
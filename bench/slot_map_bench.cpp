@@ -0,0 +1,136 @@
+#include "../slot_map.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../shared_ptr.h"
+#include "../weak_ptr.h"
+
+namespace
+{
+
+struct Entity
+{
+  float x, y, z;
+  int hp;
+};
+
+// Lookups visit every entity once in random order; half of them have been
+// destroyed before the benchmark starts.
+std::vector<std::size_t> lookup_order(std::size_t n)
+{
+  std::vector<std::size_t> order(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  return order;
+}
+
+}  // namespace
+
+static void BM_SharedVector_Iterate(benchmark::State& state)
+{
+  std::vector<smrtptrs::shared_ptr<Entity>> entities;
+  for (std::int64_t i = 0; i < state.range(0); ++i)
+  {
+    entities.push_back(smrtptrs::make_shared<Entity>(Entity{1, 2, 3, static_cast<int>(i)}));
+  }
+  for (auto _ : state)
+  {
+    long sum = 0;
+    for (const auto& e : entities)
+    {
+      sum += e->hp;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SlotMap_Iterate(benchmark::State& state)
+{
+  smrtptrs::slot_map<Entity> entities;
+  for (std::int64_t i = 0; i < state.range(0); ++i)
+  {
+    entities.insert(Entity{1, 2, 3, static_cast<int>(i)});
+  }
+  for (auto _ : state)
+  {
+    long sum = 0;
+    for (const auto& e : entities)
+    {
+      sum += e.hp;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_WeakPtr_Lookup(benchmark::State& state)
+{
+  std::size_t n = static_cast<std::size_t>(state.range(0));
+  std::vector<smrtptrs::shared_ptr<Entity>> entities;
+  std::vector<smrtptrs::weak_ptr<Entity>> observers;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    entities.push_back(smrtptrs::make_shared<Entity>(Entity{1, 2, 3, static_cast<int>(i)}));
+    observers.emplace_back(entities.back());
+  }
+  for (std::size_t i = 0; i < n; i += 2)
+  {
+    entities[i].reset();
+  }
+  auto order = lookup_order(n);
+  for (auto _ : state)
+  {
+    long sum = 0;
+    for (std::size_t i : order)
+    {
+      if (!observers[i].expired())
+      {
+        sum += observers[i].getPtr()->hp;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SlotMap_Lookup(benchmark::State& state)
+{
+  std::size_t n = static_cast<std::size_t>(state.range(0));
+  smrtptrs::slot_map<Entity> entities;
+  std::vector<smrtptrs::handle<Entity>> handles;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    handles.push_back(entities.insert(Entity{1, 2, 3, static_cast<int>(i)}));
+  }
+  for (std::size_t i = 0; i < n; i += 2)
+  {
+    entities.erase(handles[i]);
+  }
+  auto order = lookup_order(n);
+  for (auto _ : state)
+  {
+    long sum = 0;
+    for (std::size_t i : order)
+    {
+      if (const Entity* e = entities.get(handles[i]))
+      {
+        sum += e->hp;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SharedVector_Iterate)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SlotMap_Iterate)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_WeakPtr_Lookup)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SlotMap_Lookup)->Range(1 << 10, 1 << 20);
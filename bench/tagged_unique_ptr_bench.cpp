@@ -0,0 +1,131 @@
+#include "../tagged_unique_ptr.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "../unique_ptr.h"
+
+namespace
+{
+
+struct TaggedNode
+{
+  std::uint64_t key;
+  smrtptrs::tagged_unique_ptr<TaggedNode, 2> next;
+};
+
+struct SplitNode
+{
+  std::uint64_t key;
+  smrtptrs::unique_ptr<SplitNode> next;
+  std::uint8_t state;
+};
+
+// Builds the list back to front and tears it down iteratively, so that long
+// lists do not recurse through the node destructors.
+template <typename Node, typename MakeNode>
+struct List
+{
+  Node head{};
+
+  List(std::size_t n, MakeNode make)
+  {
+    for (std::size_t i = n; i > 0; --i)
+    {
+      make(head, i);
+    }
+  }
+
+  ~List()
+  {
+    auto next = std::move(head.next);
+    while (next)
+    {
+      auto after = std::move(next->next);
+      next = std::move(after);
+    }
+  }
+};
+
+auto push_tagged = [](TaggedNode& head, std::size_t i)
+{
+  auto* node = new TaggedNode{i, std::move(head.next)};
+  head.next = smrtptrs::tagged_unique_ptr<TaggedNode, 2>(node, i & 3);
+};
+
+auto push_split = [](SplitNode& head, std::size_t i)
+{
+  auto* node = new SplitNode{i, std::move(head.next), static_cast<std::uint8_t>(i & 3)};
+  head.next = smrtptrs::unique_ptr<SplitNode>(node);
+};
+
+using TaggedList = List<TaggedNode, decltype(push_tagged)>;
+using SplitList = List<SplitNode, decltype(push_split)>;
+
+}  // namespace
+
+static void BM_TaggedList_Build(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    TaggedList list(state.range(0), push_tagged);
+    benchmark::DoNotOptimize(list.head.next.get());
+  }
+  state.counters["bytes_per_node"] = sizeof(TaggedNode);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SeparateField_Build(benchmark::State& state)
+{
+  for (auto _ : state)
+  {
+    SplitList list(state.range(0), push_split);
+    benchmark::DoNotOptimize(list.head.next.get());
+  }
+  state.counters["bytes_per_node"] = sizeof(SplitNode);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_TaggedList_Traverse(benchmark::State& state)
+{
+  TaggedList list(state.range(0), push_tagged);
+  for (auto _ : state)
+  {
+    std::uint64_t sum = 0;
+    for (const auto* link = &list.head.next; *link; link = &(*link)->next)
+    {
+      if (link->tag() == 1)
+      {
+        sum += (*link)->key;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["bytes_per_node"] = sizeof(TaggedNode);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_SeparateField_Traverse(benchmark::State& state)
+{
+  SplitList list(state.range(0), push_split);
+  for (auto _ : state)
+  {
+    std::uint64_t sum = 0;
+    for (const SplitNode* node = list.head.next.get(); node; node = node->next.get())
+    {
+      if (node->state == 1)
+      {
+        sum += node->key;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["bytes_per_node"] = sizeof(SplitNode);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TaggedList_Build)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SeparateField_Build)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_TaggedList_Traverse)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SeparateField_Traverse)->Range(1 << 10, 1 << 20);
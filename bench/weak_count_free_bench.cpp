@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../shared_ptr.h"
+#include "../test/alloc_counter.h"
+
+namespace
+{
+
+struct Observed
+{
+  int value;
+};
+
+struct Unobserved
+{
+  int value;
+};
+
+}  // namespace
+
+template <>
+struct smrtptrs::weak_observable<Unobserved> : std::false_type
+{
+};
+
+constexpr std::int64_t batch = 1 << 14;
+
+// Heap bytes per make_shared object (payload + control block), measured
+// with the allocation counter.
+template <typename T>
+static void BM_MemoryPerObject(benchmark::State& state)
+{
+  std::vector<smrtptrs::shared_ptr<T>> objects;
+  objects.reserve(batch);
+  std::size_t bytes = 0;
+  for (auto _ : state)
+  {
+    AllocScope scope;
+    for (std::int64_t i = 0; i < batch; ++i)
+    {
+      objects.push_back(smrtptrs::make_shared<T>(T{static_cast<int>(i)}));
+    }
+    bytes = scope.bytes();
+    objects.clear();
+  }
+  state.counters["bytes_per_object"] = static_cast<double>(bytes) / batch;
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Releasing the last owner of each object in a batch.
+template <typename T>
+static void BM_ReleaseLastOwner(benchmark::State& state)
+{
+  std::vector<smrtptrs::shared_ptr<T>> objects;
+  objects.reserve(batch);
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    for (std::int64_t i = 0; i < batch; ++i)
+    {
+      objects.push_back(smrtptrs::make_shared<T>(T{static_cast<int>(i)}));
+    }
+    state.ResumeTiming();
+    objects.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+BENCHMARK(BM_MemoryPerObject<Observed>);
+BENCHMARK(BM_MemoryPerObject<Unobserved>);
+BENCHMARK(BM_ReleaseLastOwner<Observed>);
+BENCHMARK(BM_ReleaseLastOwner<Unobserved>);
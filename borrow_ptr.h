@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "shared_ptr.h"
+
+namespace smrtptrs
+{
+
+// Non-owning pointer to an object owned by shared_ptrs, for parameters of
+// functions that only use the object while the caller keeps it alive. A
+// shared_ptr converts to it implicitly, without touching the reference
+// count.
+//
+// With SMRTPTRS_CHECKED_BORROWS off (the default) it is a plain
+// pointer. With it on, every borrow_ptr is counted in the control block,
+// and releasing the last owner while one is still alive aborts the program
+// at that point, instead of leaving the borrow dangling.
+template <typename T>
+class borrow_ptr
+{
+  static_assert(!std::is_array<T>::value, "borrow_ptr does not support arrays");
+
+public:
+  using element_type = T;
+  using pointer_type = T*;
+
+private:
+  pointer_type ptr_;
+#if SMRTPTRS_CHECKED_BORROWS
+  std::size_t* borrows_;
+
+  void acquire() noexcept
+  {
+    if (borrows_)
+    {
+      ++*borrows_;
+    }
+  }
+
+  void release() noexcept
+  {
+    if (borrows_)
+    {
+      --*borrows_;
+    }
+  }
+#endif
+
+public:
+#if SMRTPTRS_CHECKED_BORROWS
+  borrow_ptr() noexcept : ptr_(nullptr), borrows_(nullptr) {}
+
+  template <typename D>
+  borrow_ptr(const shared_ptr<T, D>& owner) noexcept
+      : ptr_(owner.get()), borrows_(owner.block ? &owner.block->borrows : nullptr)
+  {
+    acquire();
+  }
+
+  borrow_ptr(const borrow_ptr& other) noexcept : ptr_(other.ptr_), borrows_(other.borrows_)
+  {
+    acquire();
+  }
+
+  borrow_ptr(borrow_ptr&& other) noexcept : ptr_(other.ptr_), borrows_(other.borrows_)
+  {
+    other.ptr_ = nullptr;
+    other.borrows_ = nullptr;
+  }
+
+  borrow_ptr& operator=(borrow_ptr other) noexcept
+  {
+    std::swap(ptr_, other.ptr_);
+    std::swap(borrows_, other.borrows_);
+    return *this;
+  }
+
+  ~borrow_ptr()
+  {
+    release();
+  }
+#else
+  borrow_ptr() noexcept : ptr_(nullptr) {}
+
+  template <typename D>
+  borrow_ptr(const shared_ptr<T, D>& owner) noexcept : ptr_(owner.get()) {}
+#endif
+
+  borrow_ptr(std::nullptr_t) noexcept : borrow_ptr() {}
+
+public:
+  pointer_type get() const noexcept
+  {
+    return ptr_;
+  }
+
+  T& operator*() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(ptr_ != nullptr, "Dereferencing null borrow_ptr");
+    return *ptr_;
+  }
+
+  pointer_type operator->() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(ptr_ != nullptr, "Dereferencing null borrow_ptr");
+    return ptr_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ptr_ != nullptr;
+  }
+
+  bool operator==(const borrow_ptr& other) const noexcept
+  {
+    return ptr_ == other.ptr_;
+  }
+
+  bool operator==(std::nullptr_t) const noexcept
+  {
+    return ptr_ == nullptr;
+  }
+};
+
+}  // namespace smrtptrs
@@ -0,0 +1,8 @@
+find_package(benchmark REQUIRED)
+
+macro(AddBenchmark target)
+  target_link_libraries(${target} PRIVATE benchmark::benchmark_main)
+  if (NOT CMAKE_BUILD_TYPE STREQUAL Debug)
+    target_compile_options(${target} PRIVATE -O2)
+  endif()
+endmacro()
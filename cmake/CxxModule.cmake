@@ -0,0 +1,12 @@
+function(AddModuleLibrary target source_dir)
+  if (CMAKE_VERSION VERSION_LESS 3.28)
+    message(FATAL_ERROR "The smrtptrs module needs CMake >= 3.28, found ${CMAKE_VERSION}")
+  endif()
+  add_library(${target})
+  target_sources(${target} PUBLIC FILE_SET CXX_MODULES
+                 BASE_DIRS ${source_dir}
+                 FILES ${source_dir}/smrtptrs.cppm)
+  target_include_directories(${target} PRIVATE ${source_dir})
+  target_compile_features(${target} PUBLIC cxx_std_20)
+  set_target_properties(${target} PROPERTIES CXX_SCAN_FOR_MODULES ON)
+endfunction()
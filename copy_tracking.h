@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace smrtptrs
+{
+
+// ********* copy tracking *********
+
+// With SMRTPTRS_TRACK_COPIES defined, the shared_ptr copy constructor, copy
+// assignment and weak_ptr::lock() take the caller's std::source_location
+// and count every strong reference they add, per call site and per pointee
+// type. The counts are written to std::cerr at exit (see
+// report_copies_at_exit) or on demand with report_copies(). Without the
+// define nothing is recorded and shared_ptr is unchanged. Like the access
+// policy, the mode has to be the same for every translation unit.
+//
+// Copies made inside library code, e.g. by std::vector growing, are
+// attributed to that library code.
+
+enum class copy_kind
+{
+  copy,
+  lock
+};
+
+struct copy_site
+{
+  std::string_view type;
+  std::string_view file;
+  std::string_view function;
+  std::uint_least32_t line;
+  std::uint_least32_t column;
+  copy_kind kind;
+  std::size_t count;
+};
+
+namespace detail
+{
+
+// Readable name of T, cut out of the function name GCC and Clang give.
+template <typename T>
+constexpr std::string_view type_name() noexcept
+{
+  std::string_view name = std::source_location::current().function_name();
+  auto begin = name.find("T = ");
+  if (begin == std::string_view::npos)
+  {
+    return name;
+  }
+  begin += 4;
+  auto end = name.find(';', begin);
+  if (end == std::string_view::npos)
+  {
+    end = name.rfind(']');
+  }
+  return name.substr(begin, end - begin);
+}
+
+class copy_registry
+{
+  struct key
+  {
+    std::string_view type;
+    std::string_view file;
+    std::string_view function;
+    std::uint_least32_t line;
+    std::uint_least32_t column;
+    copy_kind kind;
+
+    auto operator<=>(const key&) const = default;
+  };
+
+  std::mutex mutex_;
+  std::map<key, std::size_t> counts_;
+  bool report_at_exit_ = true;
+
+  static void report_at_exit()
+  {
+    copy_registry& registry = instance();
+    if (registry.report_at_exit_)
+    {
+      registry.report(std::cerr);
+    }
+  }
+
+  copy_registry()
+  {
+    std::atexit(&copy_registry::report_at_exit);
+  }
+
+public:
+  // Never destroyed, so copies made by static destructors still find it.
+  static copy_registry& instance()
+  {
+    static copy_registry* registry = new copy_registry;
+    return *registry;
+  }
+
+  void record(std::string_view type, copy_kind kind, const std::source_location& site)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++counts_[key{type, site.file_name(), site.function_name(), site.line(), site.column(), kind}];
+  }
+
+  std::vector<copy_site> sites()
+  {
+    std::vector<copy_site> result;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      result.reserve(counts_.size());
+      for (const auto& [k, count] : counts_)
+      {
+        result.push_back({k.type, k.file, k.function, k.line, k.column, k.kind, count});
+      }
+    }
+    std::stable_sort(result.begin(), result.end(), [](const copy_site& l, const copy_site& r) { return l.count > r.count; });
+    return result;
+  }
+
+  void report(std::ostream& os)
+  {
+    auto all = sites();
+    std::size_t total = 0;
+    std::map<std::string_view, std::size_t> per_type;
+    for (const auto& site : all)
+    {
+      total += site.count;
+      per_type[site.type] += site.count;
+    }
+
+    os << "smrtptrs copy report: " << total << " strong references added at " << all.size() << " call sites\n";
+    for (const auto& site : all)
+    {
+      os << std::setw(10) << site.count << "  " << (site.kind == copy_kind::copy ? "copy" : "lock") << "  " << site.file << ':'
+         << site.line << ':' << site.column << "  " << site.function << "  [" << site.type << "]\n";
+    }
+
+    std::vector<std::pair<std::string_view, std::size_t>> types(per_type.begin(), per_type.end());
+    std::stable_sort(types.begin(), types.end(), [](const auto& l, const auto& r) { return l.second > r.second; });
+    os << "per type:\n";
+    for (const auto& [type, count] : types)
+    {
+      os << std::setw(10) << count << "  " << type << '\n';
+    }
+  }
+
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counts_.clear();
+  }
+
+  void set_report_at_exit(bool enabled)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    report_at_exit_ = enabled;
+  }
+};
+
+template <typename T>
+void record_copy(copy_kind kind, const std::source_location& site)
+{
+  copy_registry::instance().record(type_name<T>(), kind, site);
+}
+
+}  // namespace detail
+
+// Call sites seen so far, most copies first.
+inline std::vector<copy_site> copy_sites()
+{
+  return detail::copy_registry::instance().sites();
+}
+
+// Writes the call sites, most copies first, followed by totals per type.
+inline void report_copies(std::ostream& os)
+{
+  detail::copy_registry::instance().report(os);
+}
+
+inline void reset_copy_sites()
+{
+  detail::copy_registry::instance().reset();
+}
+
+// The report goes to std::cerr at exit unless this is called with false.
+inline void report_copies_at_exit(bool enabled)
+{
+  detail::copy_registry::instance().set_report_at_exit(enabled);
+}
+
+}  // namespace smrtptrs
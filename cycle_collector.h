@@ -0,0 +1,561 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace smrtptrs
+{
+
+// Specialize for types whose shared_ptr graphs may form cycles:
+//
+//   template <>
+//   struct smrtptrs::cycle_edges<Node>
+//   {
+//     template <typename F>
+//     static void for_each(Node& node, F&& visit)
+//     {
+//       visit(node.next);  // every shared_ptr member, once per call
+//     }
+//   };
+//
+// Control blocks of such types take part in cycle collection: when one of
+// their owners goes away and others remain, the block is remembered as a
+// possible cycle root, and collect_cycles() / collect_cycles_step() reclaim
+// the groups of objects that are only kept alive by each other. Other types
+// are not affected. The specialization has to be visible wherever the type
+// is shared.
+template <typename T>
+struct cycle_edges
+{
+};
+
+namespace detail
+{
+
+struct edge_probe
+{
+  template <typename P>
+  void operator()(P&) const;
+};
+
+}  // namespace detail
+
+template <typename T>
+inline constexpr bool cycle_traced_v = !std::is_array<T>::value && requires(std::remove_cv_t<T>& object, detail::edge_probe visit) {
+  cycle_edges<std::remove_cv_t<T>>::for_each(object, visit);
+};
+
+namespace detail
+{
+
+// Bacon & Rajan, "Concurrent Cycle Collection in Reference Counted Systems".
+// purple: possible root; gray: being trial-deleted; white: trial count
+// reached zero; orange: candidate garbage awaiting the final check;
+// garbage: being reclaimed.
+enum class cycle_color : std::uint8_t
+{
+  black,
+  purple,
+  gray,
+  white,
+  orange,
+  garbage
+};
+
+struct cycle_node;
+
+// Type-erased access to a shared_ptr control block, provided by shared_ptr.
+struct cycle_ops
+{
+  std::size_t& (*count)(cycle_node*);
+  void (*for_each_child)(cycle_node*, void (*visit)(cycle_node*, void*), void* context);
+  // destroys the managed object, if it is still there; the block stays
+  bool (*destroy_object)(cycle_node*);
+  // weak reference held while the block is buffered or traced
+  void (*retain)(cycle_node*);
+  void (*release)(cycle_node*);
+};
+
+struct cycle_node
+{
+  const cycle_ops* ops = nullptr;
+  cycle_color color = cycle_color::black;
+  bool buffered = false;
+  bool traced = false;
+  // trial-deletion count, kept apart from the real count so that owners
+  // can come and go between steps
+  std::size_t trial = 0;
+};
+
+// Stands in for cycle_node in control blocks of untraced types.
+struct untraced_node
+{
+};
+
+template <typename F>
+void for_each_child(cycle_node* node, F& visit)
+{
+  node->ops->for_each_child(node, [](cycle_node* child, void* context) { (*static_cast<F*>(context))(child); }, &visit);
+}
+
+// Reference counts are not atomic, so every thread collects the cycles of
+// the objects it releases.
+//
+// A collection runs in phases that each visit one object per unit of work
+// and can stop after any of them, so the program may run, and change the
+// graph, between two steps. The real counts are never touched by trial
+// deletion, and before anything is reclaimed the candidates are checked in
+// one go: a group is only garbage if every owner of its objects is another
+// object of the group.
+class cycle_collector
+{
+  enum class phase : std::uint8_t
+  {
+    idle,
+    mark,
+    scan,
+    collect,
+    verify,
+    reclaim,
+    release
+  };
+
+  phase phase_ = phase::idle;
+  // possible roots for the next collection
+  std::vector<cycle_node*> roots_;
+  // roots of the running collection not looked at yet
+  std::vector<cycle_node*> candidates_;
+  // roots the running collection traces from
+  std::vector<cycle_node*> batch_;
+  // every object of the running collection; each holds a weak reference
+  std::vector<cycle_node*> traced_;
+  std::vector<cycle_node*> garbage_;
+  std::vector<cycle_node*> stack_;
+  std::vector<cycle_node*> black_stack_;
+  std::size_t cursor_ = 0;
+
+  static bool& torn_down() noexcept
+  {
+    thread_local bool flag = false;
+    return flag;
+  }
+
+  cycle_collector() = default;
+
+  ~cycle_collector()
+  {
+    torn_down() = true;
+    // objects already found to be garbage are freed; the rest of the
+    // collection is dropped
+    if (phase_ == phase::reclaim)
+    {
+      for (; cursor_ < garbage_.size(); ++cursor_)
+      {
+        garbage_[cursor_]->ops->destroy_object(garbage_[cursor_]);
+      }
+      cursor_ = 0;
+    }
+    for (std::size_t i = phase_ == phase::release ? cursor_ : 0; i < traced_.size(); ++i)
+    {
+      let_go(traced_[i]);
+    }
+    for (auto* roots : {&roots_, &candidates_})
+    {
+      for (cycle_node* node : *roots)
+      {
+        node->buffered = false;
+        node->ops->release(node);
+      }
+    }
+  }
+
+  static std::size_t& count(cycle_node* node)
+  {
+    return node->ops->count(node);
+  }
+
+  void trace(cycle_node* node)
+  {
+    node->traced = true;
+    node->color = cycle_color::gray;
+    node->trial = count(node);
+    traced_.push_back(node);
+    stack_.push_back(node);
+  }
+
+  // Starts tracing from the next candidate, unless it is no longer one.
+  void take_root()
+  {
+    cycle_node* node = candidates_.back();
+    candidates_.pop_back();
+    node->buffered = false;
+    if (!node->traced && node->color == cycle_color::purple && count(node) > 0)
+    {
+      // the weak reference of the buffer now belongs to the collection
+      batch_.push_back(node);
+      trace(node);
+    }
+    else
+    {
+      node->ops->release(node);
+    }
+  }
+
+  // Trial deletion: subtracts every reference from inside the subgraph.
+  void mark_gray(cycle_node* node)
+  {
+    auto visit = [this](cycle_node* child)
+    {
+      if (!child->traced)
+      {
+        child->ops->retain(child);
+        trace(child);
+      }
+      if (child->trial > 0)
+      {
+        --child->trial;
+      }
+    };
+    for_each_child(node, visit);
+  }
+
+  // Everything reachable from a live object is live.
+  void scan_black(cycle_node* node)
+  {
+    auto visit = [this](cycle_node* child)
+    {
+      if (child->traced && child->color != cycle_color::black)
+      {
+        child->color = cycle_color::black;
+        black_stack_.push_back(child);
+      }
+    };
+    for_each_child(node, visit);
+  }
+
+  void scan(cycle_node* node)
+  {
+    if (node->color != cycle_color::gray)
+    {
+      return;
+    }
+    if (node->trial > 0)
+    {
+      node->color = cycle_color::black;
+      scan_black(node);
+    }
+    else
+    {
+      node->color = cycle_color::white;
+      auto visit = [this](cycle_node* child)
+      {
+        if (child->traced)
+        {
+          stack_.push_back(child);
+        }
+      };
+      for_each_child(node, visit);
+    }
+  }
+
+  void collect_white(cycle_node* node)
+  {
+    if (node->color != cycle_color::white)
+    {
+      return;
+    }
+    node->color = cycle_color::orange;
+    garbage_.push_back(node);
+    auto visit = [this](cycle_node* child)
+    {
+      if (child->traced)
+      {
+        stack_.push_back(child);
+      }
+    };
+    for_each_child(node, visit);
+  }
+
+  // Counts the references every candidate gets from other candidates and
+  // compares them with the real counts, as they are now: candidates with
+  // an owner outside the group, and whatever they reach, are live. The
+  // survivors are marked garbage, which expires their weak_ptrs, and get
+  // one more owner, the collector, so that freeing one of them cannot
+  // free another before its turn.
+  void verify()
+  {
+    for (cycle_node* node : garbage_)
+    {
+      node->trial = 0;
+    }
+    auto internal = [](cycle_node* child)
+    {
+      if (child->color == cycle_color::orange)
+      {
+        ++child->trial;
+      }
+    };
+    for (cycle_node* node : garbage_)
+    {
+      for_each_child(node, internal);
+    }
+
+    auto live = [this](cycle_node* child)
+    {
+      if (child->color == cycle_color::orange)
+      {
+        child->color = cycle_color::black;
+        black_stack_.push_back(child);
+      }
+    };
+    for (cycle_node* node : garbage_)
+    {
+      if (node->color == cycle_color::orange && count(node) != node->trial)
+      {
+        node->color = cycle_color::black;
+        for_each_child(node, live);
+      }
+      while (!black_stack_.empty())
+      {
+        cycle_node* reached = black_stack_.back();
+        black_stack_.pop_back();
+        for_each_child(reached, live);
+      }
+    }
+
+    std::erase_if(garbage_, [](cycle_node* node) { return node->color != cycle_color::orange; });
+    for (cycle_node* node : garbage_)
+    {
+      node->color = cycle_color::garbage;
+      ++count(node);
+    }
+  }
+
+  // Drops the weak reference of an object of the finished collection.
+  void let_go(cycle_node* node)
+  {
+    node->traced = false;
+    if (node->color == cycle_color::garbage)
+    {
+      --count(node);
+    }
+    else
+    {
+      node->color = node->buffered ? cycle_color::purple : cycle_color::black;
+    }
+    node->ops->release(node);
+  }
+
+  void next_phase(phase next)
+  {
+    phase_ = next;
+    cursor_ = 0;
+  }
+
+public:
+  cycle_collector(const cycle_collector&) = delete;
+  cycle_collector& operator=(const cycle_collector&) = delete;
+
+  // nullptr while the thread is exiting
+  static cycle_collector* local() noexcept
+  {
+    if (torn_down())
+    {
+      return nullptr;
+    }
+    thread_local cycle_collector collector;
+    return &collector;
+  }
+
+  // Called when a reference to node is dropped and others remain. Objects
+  // of the running collection keep their color until it is done.
+  void possible_root(cycle_node* node)
+  {
+    if (node->color == cycle_color::garbage)
+    {
+      return;
+    }
+    if (!node->traced)
+    {
+      node->color = cycle_color::purple;
+    }
+    if (!node->buffered)
+    {
+      roots_.push_back(node);
+      node->ops->retain(node);
+      node->buffered = true;
+    }
+  }
+
+  // Advances the collection by about `budget` objects visited and returns
+  // the number of objects reclaimed. When none is running, a new one starts
+  // from every buffered root; roots buffered while it runs wait for the
+  // next. Only the final check is done at once, over the candidates found.
+  std::size_t step(std::size_t budget)
+  {
+    std::size_t work = 0;
+    std::size_t reclaimed = 0;
+    while (work < budget)
+    {
+      switch (phase_)
+      {
+        case phase::idle:
+          if (roots_.empty())
+          {
+            return reclaimed;
+          }
+          candidates_.swap(roots_);
+          next_phase(phase::mark);
+          break;
+
+        case phase::mark:
+          if (!stack_.empty())
+          {
+            cycle_node* node = stack_.back();
+            stack_.pop_back();
+            mark_gray(node);
+            ++work;
+          }
+          else if (!candidates_.empty())
+          {
+            take_root();
+            ++work;
+          }
+          else
+          {
+            next_phase(phase::scan);
+          }
+          break;
+
+        case phase::scan:
+          if (!black_stack_.empty())
+          {
+            cycle_node* node = black_stack_.back();
+            black_stack_.pop_back();
+            scan_black(node);
+            ++work;
+          }
+          else if (!stack_.empty())
+          {
+            cycle_node* node = stack_.back();
+            stack_.pop_back();
+            scan(node);
+            ++work;
+          }
+          else if (cursor_ < batch_.size())
+          {
+            stack_.push_back(batch_[cursor_++]);
+          }
+          else
+          {
+            next_phase(phase::collect);
+          }
+          break;
+
+        case phase::collect:
+          if (!stack_.empty())
+          {
+            cycle_node* node = stack_.back();
+            stack_.pop_back();
+            collect_white(node);
+            ++work;
+          }
+          else if (cursor_ < batch_.size())
+          {
+            stack_.push_back(batch_[cursor_++]);
+          }
+          else
+          {
+            next_phase(phase::verify);
+          }
+          break;
+
+        case phase::verify:
+          verify();
+          work += garbage_.size();
+          next_phase(phase::reclaim);
+          break;
+
+        case phase::reclaim:
+          if (cursor_ < garbage_.size())
+          {
+            if (garbage_[cursor_]->ops->destroy_object(garbage_[cursor_]))
+            {
+              ++reclaimed;
+            }
+            ++cursor_;
+            ++work;
+          }
+          else
+          {
+            next_phase(phase::release);
+          }
+          break;
+
+        case phase::release:
+          if (cursor_ < traced_.size())
+          {
+            let_go(traced_[cursor_++]);
+            ++work;
+          }
+          else
+          {
+            batch_.clear();
+            traced_.clear();
+            garbage_.clear();
+            next_phase(phase::idle);
+          }
+          break;
+      }
+    }
+    return reclaimed;
+  }
+
+  // Possible roots that are buffered or part of the running collection.
+  std::size_t pending() const noexcept
+  {
+    return roots_.size() + candidates_.size() + batch_.size();
+  }
+
+  bool busy() const noexcept
+  {
+    return phase_ != phase::idle || !roots_.empty();
+  }
+};
+
+}  // namespace detail
+
+// ********* cycle collection *********
+
+// Visits about `budget` objects of the calling thread's collection, which
+// picks up where the previous step stopped; returns the number of objects
+// reclaimed.
+inline std::size_t collect_cycles_step(std::size_t budget)
+{
+  auto* collector = detail::cycle_collector::local();
+  return collector ? collector->step(budget) : 0;
+}
+
+// Runs steps until the running collection is done and no possible roots
+// are left.
+inline std::size_t collect_cycles()
+{
+  auto* collector = detail::cycle_collector::local();
+  std::size_t reclaimed = 0;
+  while (collector && collector->busy())
+  {
+    reclaimed += collector->step(SIZE_MAX);
+  }
+  return reclaimed;
+}
+
+// Possible roots the calling thread's collector has not finished with.
+inline std::size_t pending_cycle_roots()
+{
+  auto* collector = detail::cycle_collector::local();
+  return collector ? collector->pending() : 0;
+}
+
+}  // namespace smrtptrs
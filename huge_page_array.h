@@ -0,0 +1,225 @@
+#pragma once
+
+#if !defined(__linux__)
+#error "huge_page_array.h needs Linux (mmap, madvise)"
+#endif
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "shared_ptr.h"
+#include "unique_ptr.h"
+
+namespace smrtptrs
+{
+
+// Huge-page arrays are mapped on 2 MiB boundaries and in whole 2 MiB units
+// so that transparent huge pages can back them.
+constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+namespace detail
+{
+
+constexpr std::size_t huge_page_bytes(std::size_t bytes) noexcept
+{
+  return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+// Maps at least `bytes` bytes of anonymous memory aligned to huge_page_size
+// and asks for transparent huge pages. The mapping is not touched here.
+inline void* map_huge_pages(std::size_t bytes)
+{
+  std::size_t length = huge_page_bytes(bytes);
+  void* raw = ::mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (raw == MAP_FAILED)
+  {
+    throw std::system_error(errno, std::generic_category(), "mmap");
+  }
+
+  // trim the head and tail so the mapping starts on a huge page boundary
+  auto begin = reinterpret_cast<std::uintptr_t>(raw);
+  auto aligned = (begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+  if (aligned != begin)
+  {
+    ::munmap(raw, aligned - begin);
+  }
+  if (std::size_t tail = begin + huge_page_size - aligned)
+  {
+    ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+  }
+
+  // best effort: huge pages may be disabled on this system
+  ::madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+  return reinterpret_cast<void*>(aligned);
+}
+
+}  // namespace detail
+
+// Deleter for arrays made by make_unique_huge / make_shared_huge: destroys
+// the elements and unmaps the memory.
+template <typename T>
+struct huge_page_delete;
+
+template <typename T>
+struct huge_page_delete<T[]>
+{
+  std::size_t size = 0;
+
+  void operator()(T* ptr)
+  {
+    if (!ptr)
+    {
+      return;
+    }
+    if constexpr (!std::is_trivially_destructible<T>::value)
+    {
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        ptr[i].~T();
+      }
+    }
+    ::munmap(ptr, detail::huge_page_bytes(size * sizeof(T)));
+  }
+};
+
+namespace detail
+{
+
+// Value-initializes [0, size) in parallel with huge-page sized slices per
+// thread, so each page is first touched, and placed, by the thread that owns
+// it. If an element throws, or a worker cannot be started, everything built
+// so far is destroyed, the memory is unmapped and the first exception is
+// rethrown.
+template <typename T>
+T* construct_huge_array(std::size_t size, unsigned threads)
+{
+  if (size == 0)
+  {
+    return nullptr;
+  }
+  // map_huge_pages rounds up by up to two huge pages
+  if (size > (std::numeric_limits<std::size_t>::max() - 2 * huge_page_size) / sizeof(T))
+  {
+    throw std::bad_array_new_length();
+  }
+  T* data = static_cast<T*>(map_huge_pages(size * sizeof(T)));
+  if (threads == 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::size_t per_page = std::max<std::size_t>(1, huge_page_size / sizeof(T));
+  std::size_t pages = (size + per_page - 1) / per_page;
+  std::size_t slice = (pages + threads - 1) / threads * per_page;
+
+  struct slice_state
+  {
+    std::size_t begin;
+    std::size_t end;
+    std::size_t built;
+    std::exception_ptr error;
+  };
+
+  std::vector<slice_state> slices;
+  std::vector<std::thread> workers;
+
+  auto build = [data](slice_state& s)
+  {
+    try
+    {
+      for (; s.built < s.end; ++s.built)
+      {
+        ::new (static_cast<void*>(data + s.built)) T();
+      }
+    }
+    catch (...)
+    {
+      s.error = std::current_exception();
+    }
+  };
+
+  auto discard = [&]
+  {
+    for (auto& worker : workers)
+    {
+      if (worker.joinable())
+      {
+        worker.join();
+      }
+    }
+    for (auto& done : slices)
+    {
+      std::destroy(data + done.begin, data + done.built);
+    }
+    ::munmap(data, huge_page_bytes(size * sizeof(T)));
+  };
+
+  try
+  {
+    for (std::size_t begin = 0; begin < size; begin += slice)
+    {
+      slices.push_back({begin, std::min(size, begin + slice), begin, nullptr});
+    }
+    workers.reserve(slices.size());
+    for (std::size_t i = 1; i < slices.size(); ++i)
+    {
+      workers.emplace_back(build, std::ref(slices[i]));
+    }
+  }
+  catch (...)
+  {
+    discard();
+    throw;
+  }
+
+  build(slices[0]);
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  for (auto& s : slices)
+  {
+    if (s.error)
+    {
+      discard();
+      std::rethrow_exception(s.error);
+    }
+  }
+  return data;
+}
+
+}  // namespace detail
+
+// ********* make_unique_huge / make_shared_huge *********
+
+// Like make_unique<T[]>(size), but the array is mmap'd, advised for huge
+// pages and value-initialized by `threads` threads (0: one per core).
+template <typename U>
+typename std::enable_if<std::is_array<U>::value, unique_ptr<U, huge_page_delete<U>>>::type make_unique_huge(std::size_t size, unsigned threads = 0)
+{
+  using element_type = typename std::remove_extent<U>::type;
+  return {detail::construct_huge_array<element_type>(size, threads), huge_page_delete<U>{size}};
+}
+
+template <typename U>
+typename std::enable_if<std::is_array<U>::value, shared_ptr<U, huge_page_delete<U>>>::type make_shared_huge(std::size_t size, unsigned threads = 0)
+{
+  using element_type = typename std::remove_extent<U>::type;
+  return shared_ptr<U, huge_page_delete<U>>(detail::construct_huge_array<element_type>(size, threads), huge_page_delete<U>{size});
+}
+
+}  // namespace smrtptrs
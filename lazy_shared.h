@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "shared_ptr.h"
+#include "weak_ptr.h"
+
+namespace smrtptrs
+{
+
+// Deleter of the control block behind a lazy_shared<T>. It also carries
+// the lazy state: the factory, a once-flag, the ready flag of the fast path
+// and the storage the object is built in. The object itself needs no
+// allocation; the factory needs one of its own when its captures do not
+// fit std::function's small buffer. The object is destroyed in place and
+// the storage goes away with the block.
+template <typename T>
+struct lazy_delete
+{
+  std::function<void(void*)> construct;
+  std::once_flag once;
+  std::atomic<bool> ready{false};
+  alignas(T) unsigned char storage[sizeof(T)];
+
+  lazy_delete() = default;
+
+  explicit lazy_delete(std::function<void(void*)> f) : construct(std::move(f)) {}
+
+  // Deleters are only copied or moved before the block exists, so only the
+  // factory is carried over.
+  lazy_delete(const lazy_delete& other) : construct(other.construct) {}
+
+  lazy_delete(lazy_delete&& other) noexcept : construct(std::move(other.construct)) {}
+
+  lazy_delete& operator=(const lazy_delete&) = delete;
+
+  void operator()(T* ptr)
+  {
+    ptr->~T();
+  }
+};
+
+// Shared ownership of a T that is built on the first get() or dereference.
+// Copies share one control block and one object; the factory runs once even
+// when several threads race for it, and later calls only load the ready
+// flag. If the factory throws, the next access tries again. Until the
+// object is built, shared_ptrs locked from a weak_ptr of a lazy_shared are
+// empty.
+//
+// Only the construction is synchronized: like shared_ptr, copies of a
+// lazy_shared must not be made or dropped concurrently.
+//
+// With the asserted or unchecked access policy, operator* and operator->
+// are noexcept like those of the other pointers, so a factory throwing from
+// them terminates the program; when it may throw, make the first access
+// through get() or share().
+template <typename T>
+class lazy_shared
+{
+  static_assert(!std::is_array<T>::value, "lazy_shared does not support arrays");
+
+public:
+  using element_type = T;
+  using pointer_type = T*;
+  using deleter_type = lazy_delete<T>;
+  using shared_type = shared_ptr<T, deleter_type>;
+  using weak_type = weak_ptr<T, deleter_type>;
+
+private:
+  using cntrl_block = typename shared_type::cntrl_block;
+
+  shared_type owner_;
+
+  pointer_type build() const
+  {
+    cntrl_block* block = owner_.block;
+    deleter_type& state = block->deleter;
+    std::call_once(state.once,
+                   [block, &state]
+                   {
+                     state.construct(state.storage);
+                     block->ptr = std::launder(reinterpret_cast<T*>(state.storage));
+                     state.construct = nullptr;
+                     state.ready.store(true, std::memory_order_release);
+                   });
+    return block->ptr;
+  }
+
+public:
+  lazy_shared() noexcept : owner_(static_cast<cntrl_block*>(nullptr), true) {}
+
+  // `construct` is called with the storage and has to placement-new a T in it.
+  explicit lazy_shared(std::function<void(void*)> construct) : owner_(new cntrl_block(nullptr, deleter_type(std::move(construct))), true) {}
+
+public:
+  // Builds the object if this is the first access; nullptr when empty.
+  pointer_type get() const
+  {
+    cntrl_block* block = owner_.block;
+    if (!block)
+    {
+      return nullptr;
+    }
+    if (block->deleter.ready.load(std::memory_order_acquire))
+    {
+      return block->ptr;
+    }
+    return build();
+  }
+
+  T& operator*() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(owner_.block != nullptr, "Dereferencing empty lazy_shared");
+    return *get();
+  }
+
+  pointer_type operator->() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(owner_.block != nullptr, "Dereferencing empty lazy_shared");
+    return get();
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return owner_.block != nullptr;
+  }
+
+  bool constructed() const noexcept
+  {
+    return owner_.block && owner_.block->deleter.ready.load(std::memory_order_acquire);
+  }
+
+  std::size_t use_count() const
+  {
+    return owner_.use_count();
+  }
+
+public:
+  // An owner of the built object.
+  shared_type share() const
+  {
+    get();
+    return owner_;
+  }
+
+  // Observes the object without building it.
+  operator weak_type() const
+  {
+    return weak_type(owner_);
+  }
+};
+
+// ********* make_lazy_shared *********
+
+// Keeps copies of args and builds T(args...) from them on first use, so a
+// throwing constructor can be retried with the same arguments.
+template <typename T, typename... Args>
+lazy_shared<T> make_lazy_shared(Args&&... args)
+{
+  return lazy_shared<T>([captured = std::make_tuple(std::forward<Args>(args)...)](void* storage)
+                        { std::apply([storage](const auto&... a) { ::new (storage) T(a...); }, captured); });
+}
+
+}  // namespace smrtptrs
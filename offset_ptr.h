@@ -0,0 +1,312 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "smrtptrs.h"
+
+namespace smrtptrs
+{
+
+// ********* offset_ptr *********
+
+// Pointer stored as the distance from its own address to the target, so it
+// stays valid when the memory holding both is mapped at another address.
+// Only meaningful for pointers that live in the same mapping as the target.
+template <typename T>
+class offset_ptr
+{
+public:
+  using element_type = T;
+  using pointer_type = T*;
+
+private:
+  template <typename U>
+  friend class offset_ptr;
+
+  // 1 can never be the distance to a correctly aligned object next to us
+  static constexpr std::ptrdiff_t null_offset = 1;
+
+  std::ptrdiff_t offset_;
+
+  static std::ptrdiff_t distance(const void* from, const void* to) noexcept
+  {
+    return reinterpret_cast<const char*>(to) - reinterpret_cast<const char*>(from);
+  }
+
+  void set(pointer_type p) noexcept
+  {
+    offset_ = p ? distance(this, p) : null_offset;
+  }
+
+public:
+  offset_ptr(pointer_type p = nullptr) noexcept
+  {
+    set(p);
+  }
+
+  offset_ptr(const offset_ptr& other) noexcept
+  {
+    set(other.get());
+  }
+
+  template <typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+  offset_ptr(const offset_ptr<U>& other) noexcept
+  {
+    set(other.get());
+  }
+
+  offset_ptr& operator=(const offset_ptr& other) noexcept
+  {
+    set(other.get());
+    return *this;
+  }
+
+  offset_ptr& operator=(pointer_type p) noexcept
+  {
+    set(p);
+    return *this;
+  }
+
+public:
+  pointer_type get() const noexcept
+  {
+    if (offset_ == null_offset)
+    {
+      return nullptr;
+    }
+    return static_cast<pointer_type>(
+        const_cast<void*>(static_cast<const void*>(reinterpret_cast<const char*>(this) + offset_)));
+  }
+
+  template <typename U = T, typename = std::enable_if_t<!std::is_void<U>::value>>
+  U& operator*() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(offset_ != null_offset, "Dereferencing null offset_ptr");
+    return *get();
+  }
+
+  pointer_type operator->() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(offset_ != null_offset, "Dereferencing null offset_ptr");
+    return get();
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return offset_ != null_offset;
+  }
+
+  bool operator==(const offset_ptr& other) const noexcept
+  {
+    return get() == other.get();
+  }
+
+  bool operator==(std::nullptr_t) const noexcept
+  {
+    return offset_ == null_offset;
+  }
+};
+
+// ********* segment *********
+
+// Allocator for a block of memory that may be mapped by several processes,
+// each at its own address. The segment object sits at the start of the
+// block; every link it keeps is an offset_ptr, and its lock and the counters
+// of offset_shared_ptr are lock-free atomics, so they work across processes.
+class segment
+{
+public:
+  static constexpr std::size_t max_align = alignof(std::max_align_t);
+
+private:
+  static constexpr std::uint64_t segment_magic = 0x736d727470747273;  // "smrtptrs"
+
+  // Header in front of every allocation; the user data follows it.
+  struct alignas(max_align) chunk
+  {
+    std::size_t size;
+    std::ptrdiff_t to_segment;
+    offset_ptr<chunk> next_free;
+  };
+
+  static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "segment needs a lock-free atomic lock");
+
+  std::uint64_t magic_;
+  std::size_t size_;
+  std::atomic<std::uint32_t> lock_;
+  std::size_t top_;
+  offset_ptr<chunk> free_;
+  offset_ptr<void> root_;
+
+  explicit segment(std::size_t size) noexcept : magic_(segment_magic), size_(size), lock_(0), top_(first_chunk()), free_(nullptr), root_(nullptr) {}
+
+  static constexpr std::size_t round_up(std::size_t n, std::size_t align) noexcept
+  {
+    return (n + align - 1) / align * align;
+  }
+
+  static constexpr std::size_t first_chunk() noexcept
+  {
+    return round_up(sizeof(segment), max_align);
+  }
+
+  char* base() noexcept
+  {
+    return reinterpret_cast<char*>(this);
+  }
+
+  static chunk* chunk_of(const void* p) noexcept
+  {
+    return reinterpret_cast<chunk*>(const_cast<char*>(static_cast<const char*>(p)) - sizeof(chunk));
+  }
+
+  void lock() noexcept
+  {
+    while (lock_.exchange(1, std::memory_order_acquire) != 0)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  void unlock() noexcept
+  {
+    lock_.store(0, std::memory_order_release);
+  }
+
+public:
+  segment(const segment&) = delete;
+  segment& operator=(const segment&) = delete;
+
+  // Formats [memory, memory + size) as an empty segment.
+  static segment* create(void* memory, std::size_t size)
+  {
+    if (reinterpret_cast<std::uintptr_t>(memory) % max_align != 0 || size < first_chunk())
+    {
+      throw std::invalid_argument("segment memory is too small or misaligned");
+    }
+    return ::new (memory) segment(size);
+  }
+
+  // Uses a segment that was created by another mapping of the same memory.
+  static segment* attach(void* memory)
+  {
+    auto* seg = std::launder(static_cast<segment*>(memory));
+    if (seg->magic_ != segment_magic)
+    {
+      throw std::runtime_error("memory does not hold a segment");
+    }
+    return seg;
+  }
+
+  // The segment that allocated p, found through the chunk header.
+  static segment* owner_of(const void* p) noexcept
+  {
+    chunk* c = chunk_of(p);
+    return reinterpret_cast<segment*>(reinterpret_cast<std::uintptr_t>(c) + c->to_segment);
+  }
+
+public:
+  void* allocate(std::size_t size)
+  {
+    size = round_up(size == 0 ? 1 : size, max_align);
+
+    lock();
+    chunk* found = nullptr;
+    for (offset_ptr<chunk>* link = &free_; *link; link = &(*link)->next_free)
+    {
+      if ((*link)->size >= size)
+      {
+        found = link->get();
+        *link = found->next_free;
+        break;
+      }
+    }
+    if (!found && top_ + sizeof(chunk) + size <= size_)
+    {
+      found = ::new (base() + top_) chunk{size, 0, nullptr};
+      found->to_segment = base() - reinterpret_cast<char*>(found);
+      top_ += sizeof(chunk) + size;
+    }
+    unlock();
+
+    if (!found)
+    {
+      throw std::bad_alloc();
+    }
+    return reinterpret_cast<char*>(found) + sizeof(chunk);
+  }
+
+  void deallocate(void* p) noexcept
+  {
+    if (!p)
+    {
+      return;
+    }
+    chunk* c = chunk_of(p);
+    lock();
+    c->next_free = free_;
+    free_ = c;
+    unlock();
+  }
+
+  // Constructs a T in the segment; pair with destroy().
+  template <typename T, typename... Args>
+  T* construct(Args&&... args)
+  {
+    static_assert(alignof(T) <= max_align, "segment allocations are aligned to max_align_t");
+    void* memory = allocate(sizeof(T));
+    try
+    {
+      return ::new (memory) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      deallocate(memory);
+      throw;
+    }
+  }
+
+  template <typename T>
+  static void destroy(T* p) noexcept
+  {
+    if (p)
+    {
+      segment* seg = owner_of(p);
+      p->~T();
+      seg->deallocate(p);
+    }
+  }
+
+public:
+  // Entry point of the object graph for processes that attach later.
+  template <typename T>
+  T* root() const noexcept
+  {
+    return static_cast<T*>(root_.get());
+  }
+
+  template <typename T>
+  void set_root(T* p) noexcept
+  {
+    root_ = static_cast<void*>(p);
+  }
+
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  std::size_t used() const noexcept
+  {
+    return top_;
+  }
+};
+
+}  // namespace smrtptrs
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "offset_ptr.h"
+
+namespace smrtptrs
+{
+
+// shared_ptr for objects allocated in a segment. The control block and the
+// object share one segment allocation, the counter is a lock-free atomic and
+// every link is an offset_ptr, so owners in several processes that map the
+// segment at different addresses can share the object without copying it.
+template <typename T>
+class offset_shared_ptr
+{
+  static_assert(!std::is_array<T>::value, "offset_shared_ptr does not support arrays");
+  static_assert(std::atomic<std::size_t>::is_always_lock_free, "offset_shared_ptr needs a lock-free counter");
+
+public:
+  using element_type = T;
+  using pointer_type = T*;
+
+private:
+  template <typename U, typename... Args>
+  friend offset_shared_ptr<U> make_offset_shared(segment& seg, Args&&... args);
+
+  struct cntrl_block
+  {
+    std::atomic<std::size_t> count;
+    T value;
+
+    template <typename... Args>
+    explicit cntrl_block(Args&&... args) : count(1), value(std::forward<Args>(args)...)
+    {
+    }
+  };
+
+  offset_ptr<cntrl_block> block;
+
+  explicit offset_shared_ptr(cntrl_block* adopted) noexcept : block(adopted) {}
+
+  void increment() noexcept
+  {
+    if (block)
+    {
+      block->count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void decrement() noexcept
+  {
+    if (block && block->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      segment::destroy(block.get());
+    }
+    block = nullptr;
+  }
+
+public:
+  offset_shared_ptr() noexcept : block(nullptr) {}
+
+  offset_shared_ptr(const offset_shared_ptr& other) noexcept : block(other.block)
+  {
+    increment();
+  }
+
+  offset_shared_ptr(offset_shared_ptr&& other) noexcept : block(other.block)
+  {
+    other.block = nullptr;
+  }
+
+  offset_shared_ptr& operator=(const offset_shared_ptr& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      block = other.block;
+      increment();
+    }
+    return *this;
+  }
+
+  offset_shared_ptr& operator=(offset_shared_ptr&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      block = other.block;
+      other.block = nullptr;
+    }
+    return *this;
+  }
+
+  ~offset_shared_ptr()
+  {
+    reset();
+  }
+
+public:
+  pointer_type get() const noexcept
+  {
+    return block ? &block->value : nullptr;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return static_cast<bool>(block);
+  }
+
+  element_type& operator*() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(static_cast<bool>(block), "Dereferencing null offset_shared_ptr");
+    return block->value;
+  }
+
+  pointer_type operator->() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(static_cast<bool>(block), "Dereferencing null offset_shared_ptr");
+    return &block->value;
+  }
+
+  bool operator==(const offset_shared_ptr& other) const noexcept
+  {
+    return block == other.block;
+  }
+
+public:
+  std::size_t use_count() const noexcept
+  {
+    return block ? block->count.load(std::memory_order_relaxed) : 0;
+  }
+
+  void reset() noexcept
+  {
+    decrement();
+  }
+};
+
+// ********* make_offset_shared *********
+
+template <typename U, typename... Args>
+offset_shared_ptr<U> make_offset_shared(segment& seg, Args&&... args)
+{
+  using cntrl_block = typename offset_shared_ptr<U>::cntrl_block;
+  return offset_shared_ptr<U>(seg.construct<cntrl_block>(std::forward<Args>(args)...));
+}
+
+}  // namespace smrtptrs
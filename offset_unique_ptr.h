@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "offset_ptr.h"
+
+namespace smrtptrs
+{
+
+// unique_ptr for objects allocated in a segment. The pointer is an
+// offset_ptr, so an offset_unique_ptr can itself live in the segment; the
+// owning segment is found from the allocation when the object is destroyed.
+template <typename T>
+class offset_unique_ptr
+{
+  static_assert(!std::is_array<T>::value, "offset_unique_ptr does not support arrays");
+
+public:
+  using element_type = T;
+  using pointer_type = T*;
+
+private:
+  offset_ptr<T> ptr_;
+
+public:
+  offset_unique_ptr() noexcept : ptr_(nullptr) {}
+
+  // Adopts an object created with segment::construct.
+  explicit offset_unique_ptr(pointer_type p) noexcept : ptr_(p) {}
+
+  offset_unique_ptr(offset_unique_ptr&& u) noexcept : ptr_(u.release()) {}
+
+  ~offset_unique_ptr()
+  {
+    reset();
+  }
+
+  offset_unique_ptr& operator=(offset_unique_ptr&& u) noexcept
+  {
+    if (this != &u)
+    {
+      reset(u.release());
+    }
+    return *this;
+  }
+
+  // disable copy from lvalue
+  offset_unique_ptr(const offset_unique_ptr&) = delete;
+  offset_unique_ptr& operator=(const offset_unique_ptr&) = delete;
+
+public:
+  pointer_type get() const noexcept
+  {
+    return ptr_.get();
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return static_cast<bool>(ptr_);
+  }
+
+  element_type& operator*() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(static_cast<bool>(ptr_), "Dereferencing null offset_unique_ptr");
+    return *get();
+  }
+
+  pointer_type operator->() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(static_cast<bool>(ptr_), "Dereferencing null offset_unique_ptr");
+    return get();
+  }
+
+public:
+  pointer_type release() noexcept
+  {
+    pointer_type p = ptr_.get();
+    ptr_ = nullptr;
+    return p;
+  }
+
+  void reset(pointer_type p = nullptr) noexcept
+  {
+    pointer_type old = ptr_.get();
+    ptr_ = p;
+    segment::destroy(old);
+  }
+
+  void swap(offset_unique_ptr& u) noexcept
+  {
+    pointer_type p = ptr_.get();
+    ptr_ = u.ptr_;
+    u.ptr_ = p;
+  }
+};
+
+// ********* make_offset_unique *********
+
+template <typename U, typename... Args>
+offset_unique_ptr<U> make_offset_unique(segment& seg, Args&&... args)
+{
+  return offset_unique_ptr<U>(seg.construct<U>(std::forward<Args>(args)...));
+}
+
+}  // namespace smrtptrs
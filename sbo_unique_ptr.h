@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "smrtptrs.h"
+
+namespace smrtptrs
+{
+
+// Owning pointer to a polymorphic Base that constructs derived objects of up
+// to N bytes inline in its own buffer and falls back to the heap otherwise.
+// Moving an inline object move-constructs it into the destination buffer.
+template <typename Base, std::size_t N = 48>
+class sbo_unique_ptr
+{
+  static_assert(!std::is_array<Base>::value, "sbo_unique_ptr does not support arrays");
+
+public:
+  using element_type = Base;
+  using pointer_type = Base*;
+
+  static constexpr std::size_t buffer_size = N;
+  static constexpr std::size_t buffer_align = alignof(std::max_align_t);
+
+  // Derived objects stored inline have to fit the buffer and move without
+  // throwing, so that moving the sbo_unique_ptr stays noexcept.
+  template <typename Derived>
+  static constexpr bool fits_inline = sizeof(Derived) <= N && alignof(Derived) <= buffer_align &&
+                                      std::is_nothrow_move_constructible<Derived>::value;
+
+private:
+  template <typename U, typename Derived, std::size_t M, typename... Args>
+  friend sbo_unique_ptr<U, M> make_sbo_unique(Args&&... args);
+
+  enum class operation
+  {
+    destroy,
+    move
+  };
+
+  using manager_type = void (*)(operation, sbo_unique_ptr& self, sbo_unique_ptr* dest) noexcept;
+
+  alignas(buffer_align) unsigned char buffer_[N];
+  pointer_type ptr_;
+  manager_type manage_;
+
+  template <typename Derived>
+  static void manage_inline(operation op, sbo_unique_ptr& self, sbo_unique_ptr* dest) noexcept
+  {
+    auto* object = std::launder(reinterpret_cast<Derived*>(self.buffer_));
+    if (op == operation::move)
+    {
+      dest->ptr_ = ::new (static_cast<void*>(dest->buffer_)) Derived(std::move(*object));
+      dest->manage_ = self.manage_;
+    }
+    object->~Derived();
+  }
+
+  template <typename Derived>
+  static void manage_heap(operation op, sbo_unique_ptr& self, sbo_unique_ptr* dest) noexcept
+  {
+    if (op == operation::move)
+    {
+      dest->ptr_ = self.ptr_;
+      dest->manage_ = self.manage_;
+    }
+    else
+    {
+      default_delete<Derived>{}(static_cast<Derived*>(self.ptr_));
+    }
+  }
+
+  template <typename Derived, typename... Args>
+  void emplace(Args&&... args)
+  {
+    if constexpr (fits_inline<Derived>)
+    {
+      ptr_ = ::new (static_cast<void*>(buffer_)) Derived(std::forward<Args>(args)...);
+      manage_ = &manage_inline<Derived>;
+    }
+    else
+    {
+      ptr_ = new Derived(std::forward<Args>(args)...);
+      manage_ = &manage_heap<Derived>;
+    }
+  }
+
+  void move_from(sbo_unique_ptr& u) noexcept
+  {
+    if (u.ptr_)
+    {
+      u.manage_(operation::move, u, this);
+      u.ptr_ = nullptr;
+      u.manage_ = nullptr;
+    }
+  }
+
+public:
+  sbo_unique_ptr() noexcept : ptr_(nullptr), manage_(nullptr) {}
+
+  // Adopts a heap object; Base needs a virtual destructor if p points to a derived type.
+  explicit sbo_unique_ptr(pointer_type p) noexcept : ptr_(p), manage_(p ? &manage_heap<Base> : nullptr) {}
+
+  sbo_unique_ptr(sbo_unique_ptr&& u) noexcept : ptr_(nullptr), manage_(nullptr)
+  {
+    move_from(u);
+  }
+
+  ~sbo_unique_ptr()
+  {
+    reset();
+  }
+
+  sbo_unique_ptr& operator=(sbo_unique_ptr&& u) noexcept
+  {
+    if (this != &u)
+    {
+      reset();
+      move_from(u);
+    }
+    return *this;
+  }
+
+  sbo_unique_ptr& operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  // disable copy from lvalue
+  sbo_unique_ptr(const sbo_unique_ptr&) = delete;
+  sbo_unique_ptr& operator=(const sbo_unique_ptr&) = delete;
+
+public:
+  pointer_type get() const noexcept
+  {
+    return ptr_;
+  }
+
+  bool is_inline() const noexcept
+  {
+    std::less<const void*> less;
+    return !less(ptr_, buffer_) && less(ptr_, buffer_ + N);
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ptr_ != nullptr;
+  }
+
+  element_type& operator*() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(ptr_ != nullptr, "Dereferencing null sbo_unique_ptr");
+    return *ptr_;
+  }
+
+  pointer_type operator->() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(ptr_ != nullptr, "Dereferencing null sbo_unique_ptr");
+    return ptr_;
+  }
+
+public:
+  void reset() noexcept
+  {
+    if (ptr_)
+    {
+      manage_(operation::destroy, *this, nullptr);
+      ptr_ = nullptr;
+      manage_ = nullptr;
+    }
+  }
+
+  void swap(sbo_unique_ptr& u) noexcept
+  {
+    sbo_unique_ptr tmp(std::move(u));
+    u = std::move(*this);
+    *this = std::move(tmp);
+  }
+};
+
+// ********* make_sbo_unique *********
+
+template <typename U, typename Derived = U, std::size_t N = 48, typename... Args>
+sbo_unique_ptr<U, N> make_sbo_unique(Args&&... args)
+{
+  static_assert(std::is_convertible<Derived*, U*>::value, "Derived has to derive from U");
+  sbo_unique_ptr<U, N> result;
+  result.template emplace<Derived>(std::forward<Args>(args)...);
+  return result;
+}
+
+}  // namespace smrtptrs
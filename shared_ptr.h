@@ -1,41 +1,177 @@
 #pragma once
 
-#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "cycle_collector.h"
 #include "smrtptrs.h"
 
+#if defined(SMRTPTRS_TRACK_COPIES)
+#include "copy_tracking.h"
+#endif
+
 namespace smrtptrs
 {
 
 template <typename T, typename D = default_delete<T>>
 class weak_ptr;
 
+template <typename T>
+class lazy_shared;
+
+template <typename T>
+class borrow_ptr;
+
+// Borrow checking (see borrow_ptr.h) is off unless SMRTPTRS_CHECKED_BORROWS
+// is defined as 1. It adds a counter to every control block, so it has to be
+// chosen for the whole program; it does not follow NDEBUG, which often
+// differs between translation units.
+#if !defined(SMRTPTRS_CHECKED_BORROWS)
+#define SMRTPTRS_CHECKED_BORROWS 0
+#endif
+
+// Specialize as std::false_type for types that are never observed through
+// weak_ptr: their control blocks then carry no weak count, the last release
+// frees the block without checking one, and weak_ptr<T> does not compile.
+template <typename T>
+struct weak_observable : std::true_type
+{
+};
+
+template <typename T>
+inline constexpr bool weak_observable_v = weak_observable<std::remove_cv_t<std::remove_extent_t<T>>>::value;
+
+// Specialize as std::true_type for types whose objects are copied and dropped
+// by different threads at the same time, one object per thread: their
+// control blocks keep the counters on a cache line of their own, with the
+// object pointer and deleter on the next one, so counters of unrelated
+// objects never share a line. Such a block takes two cache lines instead of
+// 16-32 bytes.
+template <typename T>
+struct cache_isolated : std::false_type
+{
+};
+
+template <typename T>
+inline constexpr bool cache_isolated_v = cache_isolated<std::remove_cv_t<std::remove_extent_t<T>>>::value;
+
+// What std::hardware_destructive_interference_size stands for, kept as our
+// own constant because it shapes the block layout and GCC varies the std
+// value with -mtune.
+#if !defined(SMRTPTRS_CACHE_LINE_SIZE)
+#define SMRTPTRS_CACHE_LINE_SIZE 64
+#endif
+
+inline constexpr std::size_t cache_line_size = SMRTPTRS_CACHE_LINE_SIZE;
+
+namespace detail
+{
+
+struct strong_counts
+{
+  std::size_t count;
+};
+
+struct strong_and_weak_counts
+{
+  std::size_t count;
+  std::size_t weak_count;
+};
+
+// The explicit padding keeps the compiler from placing the block's other
+// fields in the tail padding of this base.
+template <typename Counts>
+struct alignas(cache_line_size) cache_line_counts : Counts
+{
+  unsigned char padding[cache_line_size - sizeof(Counts)];
+};
+
+#if SMRTPTRS_CHECKED_BORROWS
+struct borrow_counter
+{
+  std::size_t borrows = 0;
+};
+#else
+struct borrow_counter
+{
+};
+#endif
+
+[[noreturn]] inline void borrow_violation() noexcept
+{
+  std::fputs("smrtptrs: last shared_ptr owner released while a borrow_ptr to the object is live\n", stderr);
+  std::abort();
+}
+
+// Counter part of the control block of a shared_ptr<T>.
+template <typename T>
+struct counts_for
+{
+  using counts = typename std::conditional<weak_observable_v<T>, strong_and_weak_counts, strong_counts>::type;
+  using type = typename std::conditional<cache_isolated_v<T>, cache_line_counts<counts>, counts>::type;
+};
+
+}  // namespace detail
+
 template <typename T, typename D = default_delete<T>>
 class shared_ptr
 {
 private:
   friend class weak_ptr<T, D>;
 
+  template <typename U, typename W>
+  friend class shared_ptr;
+
+  template <typename U>
+  friend class lazy_shared;
+
+  template <typename U>
+  friend class borrow_ptr;
+
   template <typename U, typename W, typename... Args>
   friend shared_ptr<U, W> make_shared(Args&&... args);
 
   template <typename U, typename W, typename... Args>
   friend shared_ptr<U, W> make_shared(std::size_t size, Args&&... args);
 
-  struct cntrl_block
-  {
-    size_t count;
-    size_t weak_count;
+  template <typename U, typename W>
+  friend void release_all(std::span<shared_ptr<U, W>> owners);
 
+  // Picked inside cntrl_block so that the traits are only looked at once a
+  // block is created, when T is complete and any specialization is visible.
+  struct cntrl_block : detail::counts_for<T>::type,
+                       std::conditional<cycle_traced_v<T>, detail::cycle_node, detail::untraced_node>::type,
+                       detail::borrow_counter
+  {
     using element_type = typename std::conditional<std::is_array<T>::value, typename std::remove_extent<T>::type, T>::type;
     using pointer_type = typename std::conditional<std::is_array<T>::value, element_type*, T*>::type;
 
+    static_assert(!cycle_traced_v<T> || weak_observable_v<T>, "cycle collection needs the weak count of the control block");
+
     pointer_type ptr;
-    D deleter;
+    [[no_unique_address]] D deleter;
 
-    cntrl_block(size_t cnt, size_t weak_cnt, pointer_type p, D d) : count(cnt), weak_count(weak_cnt), ptr(p), deleter(d) {}
+    cntrl_block(pointer_type p, D d) : ptr(p), deleter(std::move(d))
+    {
+      this->count = 1;
+      if constexpr (weak_observable_v<T>)
+      {
+        this->weak_count = 0;
+      }
+      if constexpr (cycle_traced_v<T>)
+      {
+        this->ops = &cycle_table;
+      }
+    }
   };
 
 private:
@@ -47,11 +183,18 @@ public:
   using deleter_type = D;
 
 private:
-  explicit shared_ptr(const weak_ptr<T, D>& weak, bool) : block(weak.block)
+  // A template so that overload resolution for the adopting constructor
+  // below does not instantiate weak_ptr<T, D>, which static_asserts for
+  // types that are not weak_observable.
+  template <typename W, typename = std::enable_if_t<std::is_same<W, weak_ptr<T, D>>::value>>
+  explicit shared_ptr(const W& weak, bool) : block(weak.block)
   {
     increment();
   }
 
+  // adopts a reference that was already counted in block->count
+  explicit shared_ptr(cntrl_block* adopted, bool) noexcept : block(adopted) {}
+
   void increment()
   {
     if (block)
@@ -62,28 +205,137 @@ private:
 
   void decrement()
   {
-    if (block && --block->count == 0)
+    if (block)
     {
-      if (block->ptr)
+      if (--block->count == 0)
       {
-        block->deleter(block->ptr);
-        block->ptr = nullptr;
+        destroy(block);
       }
-      if (block->weak_count == 0)
+      else if constexpr (cycle_traced_v<T>)
       {
-        delete block;
+        possible_cycle_root(block);
       }
-      block = nullptr;
+    }
+    block = nullptr;
+  }
+
+  // Every path that destroys the managed object goes through here first.
+  static void check_no_borrows([[maybe_unused]] cntrl_block* b) noexcept
+  {
+#if SMRTPTRS_CHECKED_BORROWS
+    if (b->borrows != 0)
+    {
+      detail::borrow_violation();
+    }
+#endif
+  }
+
+  static void destroy(cntrl_block* b)
+  {
+    check_no_borrows(b);
+    if constexpr (weak_observable_v<T>)
+    {
+      if (b->ptr)
+      {
+        b->deleter(b->ptr);
+        b->ptr = nullptr;
+      }
+      if (b->weak_count == 0)
+      {
+        delete b;
+      }
+    }
+    else
+    {
+      b->deleter(b->ptr);
+      delete b;
+    }
+  }
+
+  // ********* cycle collection *********
+
+  static void possible_cycle_root(cntrl_block* b)
+  {
+    if (auto* collector = detail::cycle_collector::local())
+    {
+      collector->possible_root(b);
     }
   }
 
+  static std::size_t& cycle_count(detail::cycle_node* n)
+  {
+    return static_cast<cntrl_block*>(n)->count;
+  }
+
+  static void cycle_children(detail::cycle_node* n, void (*visit)(detail::cycle_node*, void*), void* context)
+  {
+    auto* b = static_cast<cntrl_block*>(n);
+    if (!b->ptr)
+    {
+      return;
+    }
+    cycle_edges<std::remove_cv_t<T>>::for_each(*b->ptr,
+                                               [visit, context]<typename U, typename W>(const shared_ptr<U, W>& edge)
+                                               {
+                                                 if constexpr (cycle_traced_v<U>)
+                                                 {
+                                                   if (edge.block)
+                                                   {
+                                                     visit(edge.block, context);
+                                                   }
+                                                 }
+                                               });
+  }
+
+  static bool cycle_destroy_object(detail::cycle_node* n)
+  {
+    auto* b = static_cast<cntrl_block*>(n);
+    auto* p = b->ptr;
+    if (!p)
+    {
+      return false;
+    }
+    check_no_borrows(b);
+    // cleared first: the object's own edges may drop the count to zero
+    b->ptr = nullptr;
+    b->deleter(p);
+    return true;
+  }
+
+  static void cycle_retain(detail::cycle_node* n)
+  {
+    ++static_cast<cntrl_block*>(n)->weak_count;
+  }
+
+  static void cycle_release(detail::cycle_node* n)
+  {
+    auto* b = static_cast<cntrl_block*>(n);
+    if (--b->weak_count == 0 && b->count == 0)
+    {
+      delete b;
+    }
+  }
+
+  static constexpr detail::cycle_ops cycle_table{&cycle_count, &cycle_children, &cycle_destroy_object, &cycle_retain, &cycle_release};
+
 public:
-  explicit shared_ptr(pointer_type ptr = nullptr, deleter_type d = D()) : block(ptr ? new cntrl_block{1, 0, ptr, d} : nullptr) {}
+  explicit shared_ptr(pointer_type ptr = nullptr, deleter_type d = D()) : block(ptr ? new cntrl_block(ptr, std::move(d)) : nullptr) {}
 
+#if defined(SMRTPTRS_TRACK_COPIES)
+  shared_ptr(const shared_ptr& other, std::source_location site = std::source_location::current()) : block(other.block)
+  {
+    increment();
+    if (block)
+    {
+      detail::record_copy<T>(copy_kind::copy, site);
+    }
+  }
+#else
   shared_ptr(const shared_ptr& other) : block(other.block)
   {
     increment();
   }
+#endif
 
   shared_ptr(shared_ptr&& other) noexcept : block(other.block)
   {
@@ -91,6 +343,15 @@ public:
   }
 
 public:
+#if defined(SMRTPTRS_TRACK_COPIES)
+  // Copy assignment cannot take a source_location, so it takes its argument
+  // by value: the copy constructor records the copy at the caller's site.
+  shared_ptr& operator=(shared_ptr other) noexcept
+  {
+    std::swap(block, other.block);
+    return *this;
+  }
+#else
   shared_ptr& operator=(const shared_ptr& other)
   {
     if (this != &other)
@@ -112,6 +373,7 @@ public:
     }
     return *this;
   }
+#endif
 
   shared_ptr& operator=(std::nullptr_t)
   {
@@ -126,21 +388,15 @@ public:
   }
 
 public:
-  element_type& operator*() const
+  element_type& operator*() const noexcept(!access_policy::throws)
   {
-    if (!block || !block->ptr)
-    {
-      throw std::runtime_error("Dereferencing null shared_ptr");
-    }
+    access_policy::require(block && block->ptr, "Dereferencing null shared_ptr");
     return *block->ptr;
   }
 
-  pointer_type operator->() const
+  pointer_type operator->() const noexcept(!access_policy::throws)
   {
-    if (!block || !block->ptr)
-    {
-      throw std::runtime_error("Dereferencing null shared_ptr");
-    }
+    access_policy::require(block && block->ptr, "Dereferencing null shared_ptr");
     return block->ptr;
   }
 
@@ -200,10 +456,85 @@ public:
   void reset(pointer_type def_ptr, D d = D())
   {
     reset();
-    block = def_ptr ? new cntrl_block{1, 0, def_ptr, d} : nullptr;
+    block = def_ptr ? new cntrl_block(def_ptr, std::move(d)) : nullptr;
+  }
+
+public:
+  // Hands out n new owners of the managed object with a single counter update.
+  // If writing to `out` throws, the owners not handed out yet are taken back.
+  template <typename OutputIt>
+  OutputIt share_n(std::size_t n, OutputIt out) const
+  {
+    if (block)
+    {
+      block->count += n;
+    }
+    std::size_t handed = 0;
+    try
+    {
+      for (; handed < n; ++handed)
+      {
+        // `owner` accounts for its reference from here on, even if the write throws
+        shared_ptr owner(block, true);
+        *out++ = std::move(owner);
+      }
+    }
+    catch (...)
+    {
+      // `*this` still owns a reference, so this never drops the count to zero
+      if (block)
+      {
+        block->count -= n - handed - 1;
+      }
+      throw;
+    }
+    return out;
+  }
+
+  std::vector<shared_ptr> share_n(std::size_t n) const
+  {
+    std::vector<shared_ptr> owners;
+    owners.reserve(n);
+    share_n(n, std::back_inserter(owners));
+    return owners;
   }
 };
 
+// ********* release_all *********
+
+// Releases every owner in the span with one counter update per distinct
+// control block. The span is reordered and left holding empty pointers.
+template <typename U, typename W>
+void release_all(std::span<shared_ptr<U, W>> owners)
+{
+  std::sort(owners.begin(), owners.end(), [](const shared_ptr<U, W>& l, const shared_ptr<U, W>& r)
+            { return std::less<>{}(l.block, r.block); });
+
+  for (auto first = owners.begin(); first != owners.end();)
+  {
+    auto* block = first->block;
+    auto last = first;
+    for (; last != owners.end() && last->block == block; ++last)
+    {
+      last->block = nullptr;
+    }
+
+    if (block)
+    {
+      block->count -= static_cast<std::size_t>(last - first);
+      if (block->count == 0)
+      {
+        shared_ptr<U, W>::destroy(block);
+      }
+      else if constexpr (cycle_traced_v<U>)
+      {
+        shared_ptr<U, W>::possible_cycle_root(block);
+      }
+    }
+    first = last;
+  }
+}
+
 // ********* make_shared *********
 
 template <typename U, typename D = default_delete<U>, typename... Args>
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "shared_ptr.h"
+
+namespace smrtptrs
+{
+
+// A range of elements inside an array owned by shared_ptr<T[], D>. Every
+// shared_span of the same array, whatever part it views, shares that
+// array's control block, so slicing costs one count increment and no copy.
+template <typename T, typename D = default_delete<T[]>>
+class shared_span
+{
+public:
+  using element_type = T;
+  using pointer_type = T*;
+  using owner_type = shared_ptr<T[], D>;
+  using iterator = T*;
+
+private:
+  owner_type owner_;
+  pointer_type data_;
+  std::size_t size_;
+
+  void check_slice(std::size_t offset, std::size_t count) const
+  {
+    if (offset > size_ || count > size_ - offset)
+    {
+      throw std::out_of_range("shared_span slice is out of range");
+    }
+  }
+
+public:
+  shared_span() noexcept : owner_(), data_(nullptr), size_(0) {}
+
+  // Views all `size` elements of the array.
+  shared_span(owner_type owner, std::size_t size) noexcept : owner_(std::move(owner)), data_(owner_.get()), size_(size) {}
+
+  // Views [data, data + size), which has to lie inside the owner's array.
+  shared_span(owner_type owner, pointer_type data, std::size_t size) noexcept : owner_(std::move(owner)), data_(data), size_(size) {}
+
+public:
+  pointer_type data() const noexcept
+  {
+    return data_;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  std::size_t size_bytes() const noexcept
+  {
+    return size_ * sizeof(T);
+  }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  T& operator[](std::size_t i) const
+  {
+    return data_[i];
+  }
+
+  iterator begin() const noexcept
+  {
+    return data_;
+  }
+
+  iterator end() const noexcept
+  {
+    return data_ + size_;
+  }
+
+  const owner_type& owner() const noexcept
+  {
+    return owner_;
+  }
+
+  std::size_t use_count() const
+  {
+    return owner_.use_count();
+  }
+
+public:
+  // Elements [offset, offset + count) sharing this span's owner; throws
+  // std::out_of_range when they do not fit.
+  shared_span slice(std::size_t offset, std::size_t count) const&
+  {
+    check_slice(offset, count);
+    return shared_span(owner_, data_ + offset, count);
+  }
+
+  // Hands this span's reference to the slice instead of taking a new one.
+  shared_span slice(std::size_t offset, std::size_t count) &&
+  {
+    check_slice(offset, count);
+    return shared_span(std::move(owner_), data_ + offset, count);
+  }
+
+  // Elements from offset to the end; throws std::out_of_range when offset is
+  // past the end.
+  shared_span slice(std::size_t offset) const&
+  {
+    if (offset > size_)
+    {
+      throw std::out_of_range("shared_span slice is out of range");
+    }
+    return slice(offset, size_ - offset);
+  }
+
+  shared_span slice(std::size_t offset) &&
+  {
+    if (offset > size_)
+    {
+      throw std::out_of_range("shared_span slice is out of range");
+    }
+    return std::move(*this).slice(offset, size_ - offset);
+  }
+
+public:
+  // The returned views do not keep the array alive.
+  std::span<T> span() const noexcept
+  {
+    return {data_, size_};
+  }
+
+  operator std::span<T>() const noexcept
+  {
+    return span();
+  }
+
+  template <typename U = T, typename = std::enable_if_t<!std::is_const<U>::value>>
+  operator std::span<const U>() const noexcept
+  {
+    return span();
+  }
+};
+
+using shared_buffer = shared_span<char>;
+
+// ********* make_shared_span / make_shared_buffer *********
+
+// A value-initialized array of `size` elements viewed as a whole.
+template <typename T = char>
+shared_span<T> make_shared_span(std::size_t size)
+{
+  return shared_span<T>(make_shared<T[]>(size), size);
+}
+
+inline shared_buffer make_shared_buffer(std::size_t size)
+{
+  return make_shared_span<char>(size);
+}
+
+}  // namespace smrtptrs
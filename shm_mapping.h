@@ -0,0 +1,117 @@
+#pragma once
+
+#if !defined(__linux__)
+#error "shm_mapping.h needs Linux (memfd_create, shm_open, mmap)"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+namespace smrtptrs
+{
+
+// One MAP_SHARED view of a shared memory file descriptor. Each process, or
+// each shm_mapping within a process, may see the memory at another address;
+// a segment built on it only stores offsets, so every view can use it.
+class shm_mapping
+{
+  void* data_;
+  std::size_t size_;
+
+public:
+  shm_mapping(int fd, std::size_t size) : data_(::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)), size_(size)
+  {
+    if (data_ == MAP_FAILED)
+    {
+      throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+  }
+
+  shm_mapping(shm_mapping&& other) noexcept : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+  shm_mapping& operator=(shm_mapping&& other) noexcept
+  {
+    if (this != &other)
+    {
+      unmap();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  ~shm_mapping()
+  {
+    unmap();
+  }
+
+  // disable copy from lvalue
+  shm_mapping(const shm_mapping&) = delete;
+  shm_mapping& operator=(const shm_mapping&) = delete;
+
+public:
+  void* data() const noexcept
+  {
+    return data_;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+private:
+  void unmap() noexcept
+  {
+    if (data_)
+    {
+      ::munmap(data_, size_);
+      data_ = nullptr;
+    }
+  }
+};
+
+namespace detail
+{
+
+inline int sized_fd(int fd, std::size_t size, const char* what)
+{
+  if (fd < 0)
+  {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+  if (size != 0 && ::ftruncate(fd, static_cast<off_t>(size)) != 0)
+  {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "ftruncate");
+  }
+  return fd;
+}
+
+}  // namespace detail
+
+// Anonymous shared memory of the given size; share the descriptor with
+// child processes (fork) or over a unix socket. The caller closes it.
+inline int memfd_segment(const char* name, std::size_t size)
+{
+  return detail::sized_fd(::memfd_create(name, MFD_CLOEXEC), size, "memfd_create");
+}
+
+// Named POSIX shared memory (/dev/shm/<name>). With create set the object
+// is created and sized, otherwise an existing one is opened and size is
+// ignored. The caller closes the descriptor and shm_unlink()s the name.
+inline int shm_segment(const char* name, std::size_t size, bool create)
+{
+  int flags = create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR;
+  return detail::sized_fd(::shm_open(name, flags, 0600), create ? size : 0, "shm_open");
+}
+
+}  // namespace smrtptrs
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "shared_ptr.h"
+
+namespace smrtptrs
+{
+
+// Index + generation of an object in a slot_map. A handle is a plain value:
+// it does not keep anything alive, and it turns stale once the object is
+// erased, even if the slot is reused. Generations start at 1, so a
+// default-constructed handle is never valid.
+template <typename T>
+struct handle
+{
+  std::uint32_t index = 0;
+  std::uint32_t generation = 0;
+
+  bool operator==(const handle&) const = default;
+};
+
+// Stores objects contiguously and hands out generational handles. Checking
+// a handle is one comparison against the dense generation array, with no
+// control block per object. Erasing moves the last object into the gap, so
+// pointers and references into the map are invalidated by insert and erase;
+// handles are not.
+template <typename T>
+class slot_map
+{
+public:
+  using value_type = T;
+  using handle_type = handle<T>;
+  using iterator = typename std::vector<T>::iterator;
+  using const_iterator = typename std::vector<T>::const_iterator;
+
+private:
+  static constexpr std::uint32_t no_slot = UINT32_MAX;
+
+  // dense index of the object while occupied, next free slot otherwise
+  std::vector<std::uint32_t> slot_index_;
+  std::vector<std::uint32_t> generations_;
+  std::vector<T> values_;
+  // slot of each dense object, to patch slot_index_ when erase moves one
+  std::vector<std::uint32_t> value_slot_;
+  std::uint32_t free_head_ = no_slot;
+
+  // Makes room for one more element, growing geometrically.
+  template <typename V>
+  static void reserve_one(std::vector<V>& v)
+  {
+    if (v.size() == v.capacity())
+    {
+      v.reserve(v.empty() ? 4 : v.size() * 2);
+    }
+  }
+
+  // Skips 0 when the counter wraps around.
+  void bump_generation(std::uint32_t slot) noexcept
+  {
+    if (++generations_[slot] == 0)
+    {
+      generations_[slot] = 1;
+    }
+  }
+
+  // Only called once every array has room, so it cannot throw.
+  handle_type occupy(std::uint32_t dense) noexcept
+  {
+    std::uint32_t slot;
+    if (free_head_ != no_slot)
+    {
+      slot = free_head_;
+      free_head_ = slot_index_[slot];
+      slot_index_[slot] = dense;
+    }
+    else
+    {
+      slot = static_cast<std::uint32_t>(slot_index_.size());
+      slot_index_.push_back(dense);
+      generations_.push_back(1);
+    }
+    value_slot_.push_back(slot);
+    return {slot, generations_[slot]};
+  }
+
+public:
+  template <typename... Args>
+  handle_type emplace(Args&&... args)
+  {
+    // everything that can throw comes before the map changes
+    if (free_head_ == no_slot)
+    {
+      reserve_one(slot_index_);
+      reserve_one(generations_);
+    }
+    reserve_one(value_slot_);
+    values_.emplace_back(std::forward<Args>(args)...);
+    return occupy(static_cast<std::uint32_t>(values_.size() - 1));
+  }
+
+  handle_type insert(const T& value)
+  {
+    return emplace(value);
+  }
+
+  handle_type insert(T&& value)
+  {
+    return emplace(std::move(value));
+  }
+
+  bool contains(handle_type h) const noexcept
+  {
+    return h.index < generations_.size() && generations_[h.index] == h.generation;
+  }
+
+  // nullptr for a stale handle
+  T* get(handle_type h) noexcept
+  {
+    return contains(h) ? &values_[slot_index_[h.index]] : nullptr;
+  }
+
+  const T* get(handle_type h) const noexcept
+  {
+    return contains(h) ? &values_[slot_index_[h.index]] : nullptr;
+  }
+
+  T& operator[](handle_type h) noexcept(!access_policy::throws)
+  {
+    access_policy::require(contains(h), "Accessing slot_map through a stale handle");
+    return values_[slot_index_[h.index]];
+  }
+
+  const T& operator[](handle_type h) const noexcept(!access_policy::throws)
+  {
+    access_policy::require(contains(h), "Accessing slot_map through a stale handle");
+    return values_[slot_index_[h.index]];
+  }
+
+  bool erase(handle_type h)
+  {
+    if (!contains(h))
+    {
+      return false;
+    }
+    std::uint32_t dense = slot_index_[h.index];
+    std::uint32_t last = static_cast<std::uint32_t>(values_.size() - 1);
+    if (dense != last)
+    {
+      values_[dense] = std::move(values_[last]);
+      value_slot_[dense] = value_slot_[last];
+      slot_index_[value_slot_[dense]] = dense;
+    }
+    values_.pop_back();
+    value_slot_.pop_back();
+
+    bump_generation(h.index);
+    slot_index_[h.index] = free_head_;
+    free_head_ = h.index;
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    for (std::uint32_t dense = 0; dense < value_slot_.size(); ++dense)
+    {
+      std::uint32_t slot = value_slot_[dense];
+      bump_generation(slot);
+      slot_index_[slot] = free_head_;
+      free_head_ = slot;
+    }
+    values_.clear();
+    value_slot_.clear();
+  }
+
+  std::size_t size() const noexcept
+  {
+    return values_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  void reserve(std::size_t n)
+  {
+    slot_index_.reserve(n);
+    generations_.reserve(n);
+    values_.reserve(n);
+    value_slot_.reserve(n);
+  }
+
+public:
+  // Objects in dense order, which changes on erase.
+  iterator begin() noexcept
+  {
+    return values_.begin();
+  }
+
+  iterator end() noexcept
+  {
+    return values_.end();
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return values_.begin();
+  }
+
+  const_iterator end() const noexcept
+  {
+    return values_.end();
+  }
+
+public:
+  // ********* shared_ptr interop *********
+
+  // Stores a copy of the object a shared_ptr points to.
+  template <typename D>
+  handle_type insert_shared(const shared_ptr<T, D>& ptr)
+  {
+    return emplace(*ptr);
+  }
+
+  // Moves the object out of the map into a new shared_ptr and erases its
+  // slot; an empty shared_ptr for a stale handle.
+  shared_ptr<T> extract_shared(handle_type h)
+  {
+    T* value = get(h);
+    if (!value)
+    {
+      return shared_ptr<T>();
+    }
+    auto result = make_shared<T>(std::move(*value));
+    erase(h);
+    return result;
+  }
+};
+
+}  // namespace smrtptrs
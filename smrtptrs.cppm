@@ -0,0 +1,117 @@
+// Named module interface for the library. The headers stay the primary
+// source and can still be included directly; this unit only re-exports
+// their declarations so that importers parse them once.
+module;
+
+#include "borrow_ptr.h"
+#include "cycle_collector.h"
+#include "lazy_shared.h"
+#include "offset_ptr.h"
+#include "offset_shared_ptr.h"
+#include "offset_unique_ptr.h"
+#include "sbo_unique_ptr.h"
+#include "shared_ptr.h"
+#include "shared_span.h"
+#include "slot_map.h"
+#include "smrtptrs.h"
+#include "tagged_unique_ptr.h"
+#include "unique_ptr.h"
+#include "weak_ptr.h"
+
+// copy tracking brings in <iostream> and only records anything when the
+// module is built with SMRTPTRS_TRACK_COPIES
+#if defined(SMRTPTRS_TRACK_COPIES)
+#include "copy_tracking.h"
+#endif
+
+#if defined(__linux__)
+#include "huge_page_array.h"
+#include "shm_mapping.h"
+#endif
+
+export module smrtptrs;
+
+export namespace smrtptrs
+{
+
+using smrtptrs::default_delete;
+
+using smrtptrs::access_policy;
+using smrtptrs::asserted_access;
+using smrtptrs::checked_access;
+using smrtptrs::unchecked_access;
+
+using smrtptrs::make_unique;
+using smrtptrs::unique_ptr;
+using smrtptrs::operator==;
+using smrtptrs::operator!=;
+using smrtptrs::operator<=;
+using smrtptrs::operator<;
+using smrtptrs::operator>=;
+using smrtptrs::operator>;
+
+using smrtptrs::make_sbo_unique;
+using smrtptrs::sbo_unique_ptr;
+
+using smrtptrs::make_tagged_unique;
+using smrtptrs::tagged_unique_ptr;
+
+using smrtptrs::make_shared;
+using smrtptrs::release_all;
+using smrtptrs::shared_ptr;
+using smrtptrs::weak_observable;
+using smrtptrs::weak_observable_v;
+using smrtptrs::cache_isolated;
+using smrtptrs::cache_isolated_v;
+using smrtptrs::cache_line_size;
+
+using smrtptrs::weak_ptr;
+
+using smrtptrs::borrow_ptr;
+
+using smrtptrs::lazy_delete;
+using smrtptrs::lazy_shared;
+using smrtptrs::make_lazy_shared;
+
+using smrtptrs::make_shared_buffer;
+using smrtptrs::make_shared_span;
+using smrtptrs::shared_buffer;
+using smrtptrs::shared_span;
+
+using smrtptrs::collect_cycles;
+using smrtptrs::collect_cycles_step;
+using smrtptrs::cycle_edges;
+using smrtptrs::cycle_traced_v;
+using smrtptrs::pending_cycle_roots;
+
+#if defined(SMRTPTRS_TRACK_COPIES)
+using smrtptrs::copy_kind;
+using smrtptrs::copy_site;
+using smrtptrs::copy_sites;
+using smrtptrs::report_copies;
+using smrtptrs::report_copies_at_exit;
+using smrtptrs::reset_copy_sites;
+#endif
+
+using smrtptrs::handle;
+using smrtptrs::slot_map;
+
+using smrtptrs::offset_ptr;
+using smrtptrs::segment;
+using smrtptrs::make_offset_unique;
+using smrtptrs::offset_unique_ptr;
+using smrtptrs::make_offset_shared;
+using smrtptrs::offset_shared_ptr;
+
+#if defined(__linux__)
+using smrtptrs::huge_page_delete;
+using smrtptrs::huge_page_size;
+using smrtptrs::make_shared_huge;
+using smrtptrs::make_unique_huge;
+
+using smrtptrs::memfd_segment;
+using smrtptrs::shm_mapping;
+using smrtptrs::shm_segment;
+#endif
+
+}  // namespace smrtptrs
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <cassert>
+#include <stdexcept>
+
 namespace smrtptrs
 {
 
 template <typename T>
 struct default_delete
 {
-  void operator()(T* ptr)
+  constexpr void operator()(T* ptr)
   {
     delete ptr;
   }
@@ -15,10 +18,60 @@ struct default_delete
 template <typename T>
 struct default_delete<T[]>
 {
-  void operator()(T* ptr)
+  constexpr void operator()(T* ptr)
   {
     delete[] ptr;
   }
 };
 
+// ********* access policies *********
+
+// Null checks done by operator* / operator-> of unique_ptr, shared_ptr,
+// tagged_unique_ptr, sbo_unique_ptr, offset_ptr, offset_unique_ptr,
+// offset_shared_ptr, borrow_ptr and lazy_shared, and by slot_map's
+// operator[] for stale handles. weak_ptr::getPtr is deliberately left out:
+// it does not dereference anything, and it returns nullptr for an empty
+// weak_ptr in every mode. The policy is picked per build:
+//   default                    checked_access, throws std::runtime_error
+//   SMRTPTRS_ASSERTED_ACCESS   asserted_access, assert() only (gone with NDEBUG)
+//   SMRTPTRS_UNCHECKED_ACCESS  unchecked_access, no check at all
+// Every translation unit of a program has to use the same mode.
+struct checked_access
+{
+  static constexpr bool throws = true;
+
+  static constexpr void require(bool valid, const char* what)
+  {
+    if (!valid)
+    {
+      throw std::runtime_error(what);
+    }
+  }
+};
+
+struct asserted_access
+{
+  static constexpr bool throws = false;
+
+  static constexpr void require([[maybe_unused]] bool valid, [[maybe_unused]] const char* what) noexcept
+  {
+    assert(valid && what);
+  }
+};
+
+struct unchecked_access
+{
+  static constexpr bool throws = false;
+
+  static constexpr void require(bool, const char*) noexcept {}
+};
+
+#if defined(SMRTPTRS_UNCHECKED_ACCESS)
+using access_policy = unchecked_access;
+#elif defined(SMRTPTRS_ASSERTED_ACCESS)
+using access_policy = asserted_access;
+#else
+using access_policy = checked_access;
+#endif
+
 }  // namespace smrtptrs
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "unique_ptr.h"
+
+namespace smrtptrs
+{
+
+// Owning pointer that keeps up to Bits bits of user state in the low
+// alignment bits of the stored pointer, so pointer + tag fit in one word.
+template <typename T, std::size_t Bits, typename D = default_delete<T>>
+class tagged_unique_ptr
+{
+  static_assert(!std::is_array<T>::value, "tagged_unique_ptr does not support arrays");
+  static_assert(Bits > 0, "tagged_unique_ptr needs at least one tag bit");
+
+public:
+  using element_type = T;
+  using pointer_type = T*;
+  using deleter_type = D;
+  using tag_type = std::uintptr_t;
+
+  static constexpr tag_type tag_mask = (tag_type{1} << Bits) - 1;
+
+private:
+  static pointer_type untag(pointer_type p) noexcept
+  {
+    return reinterpret_cast<pointer_type>(reinterpret_cast<tag_type>(p) & ~tag_mask);
+  }
+
+  // T may still be incomplete at class scope (e.g. self-referential nodes),
+  // so the alignment requirement is checked where the tag is first applied.
+  static pointer_type pack(pointer_type p, tag_type t) noexcept
+  {
+    static_assert(alignof(T) >= (std::size_t{1} << Bits), "alignof(T) leaves too few low bits for the tag");
+    return reinterpret_cast<pointer_type>(reinterpret_cast<tag_type>(p) | t);
+  }
+
+  struct untag_delete
+  {
+    [[no_unique_address]] D deleter;
+
+    void operator()(pointer_type p)
+    {
+      if (pointer_type raw = untag(p))
+      {
+        deleter(raw);
+      }
+    }
+  };
+
+  unique_ptr<T, untag_delete> ptr_;
+
+public:
+  tagged_unique_ptr() noexcept : ptr_(nullptr) {}
+
+  explicit tagged_unique_ptr(pointer_type ptr, tag_type t = 0, deleter_type d = deleter_type()) noexcept
+      : ptr_(pack(ptr, t & tag_mask), untag_delete{d})
+  {
+    assert(t <= tag_mask);
+  }
+
+  tagged_unique_ptr(tagged_unique_ptr&& u) noexcept = default;
+  tagged_unique_ptr& operator=(tagged_unique_ptr&& u) noexcept = default;
+
+  // disable copy from lvalue
+  tagged_unique_ptr(const tagged_unique_ptr&) = delete;
+  tagged_unique_ptr& operator=(const tagged_unique_ptr&) = delete;
+
+public:
+  pointer_type get() const noexcept
+  {
+    return untag(ptr_.get());
+  }
+
+  tag_type tag() const noexcept
+  {
+    return reinterpret_cast<tag_type>(ptr_.get()) & tag_mask;
+  }
+
+  void set_tag(tag_type t) noexcept
+  {
+    assert(t <= tag_mask);
+    ptr_.reset(pack(untag(ptr_.release()), t & tag_mask));
+  }
+
+  deleter_type& get_deleter() noexcept
+  {
+    return ptr_.get_deleter().deleter;
+  }
+
+  const deleter_type& get_deleter() const noexcept
+  {
+    return ptr_.get_deleter().deleter;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return get() != nullptr;
+  }
+
+  element_type& operator*() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(get() != nullptr, "Dereferencing null tagged_unique_ptr");
+    return *get();
+  }
+
+  pointer_type operator->() const noexcept(!access_policy::throws)
+  {
+    access_policy::require(get() != nullptr, "Dereferencing null tagged_unique_ptr");
+    return get();
+  }
+
+public:
+  // Gives up ownership; the tag is cleared.
+  pointer_type release() noexcept
+  {
+    return untag(ptr_.release());
+  }
+
+  // Replaces the owned object; the tag is kept.
+  void reset(pointer_type p = nullptr) noexcept
+  {
+    ptr_.reset(pack(p, tag()));
+  }
+
+  void reset(pointer_type p, tag_type t) noexcept
+  {
+    assert(t <= tag_mask);
+    ptr_.reset(pack(p, t & tag_mask));
+  }
+
+  void swap(tagged_unique_ptr& u) noexcept
+  {
+    ptr_.swap(u.ptr_);
+  }
+};
+
+template <typename U, std::size_t Bits, typename... Args>
+tagged_unique_ptr<U, Bits> make_tagged_unique(typename tagged_unique_ptr<U, Bits>::tag_type tag, Args&&... args)
+{
+  return tagged_unique_ptr<U, Bits>(new U(std::forward<Args>(args)...), tag);
+}
+
+}  // namespace smrtptrs
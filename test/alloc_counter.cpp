@@ -0,0 +1,161 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+thread_local AllocCounts counts{0, 0, 0};
+
+void* countedAlloc(std::size_t size, std::size_t align = 0) noexcept
+{
+  if (size == 0)
+  {
+    size = 1;
+  }
+  void* p = nullptr;
+  if (align > alignof(std::max_align_t))
+  {
+    p = std::aligned_alloc(align, (size + align - 1) / align * align);
+  }
+  else
+  {
+    p = std::malloc(size);
+  }
+  if (p)
+  {
+    ++counts.allocations;
+    counts.bytes += size;
+  }
+  return p;
+}
+
+void* countedAllocOrThrow(std::size_t size, std::size_t align = 0)
+{
+  if (void* p = countedAlloc(size, align))
+  {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void countedFree(void* p) noexcept
+{
+  if (p)
+  {
+    ++counts.frees;
+    std::free(p);
+  }
+}
+
+}  // namespace
+
+AllocCounts currentAllocCounts()
+{
+  return counts;
+}
+
+// ********* replaceable allocation functions *********
+
+void* operator new(std::size_t size)
+{
+  return countedAllocOrThrow(size);
+}
+
+void* operator new[](std::size_t size)
+{
+  return countedAllocOrThrow(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+  return countedAllocOrThrow(size, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+  return countedAllocOrThrow(size, static_cast<std::size_t>(align));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+  return countedAlloc(size, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+  return countedAlloc(size, static_cast<std::size_t>(align));
+}
+
+// ********* replaceable deallocation functions *********
+
+void operator delete(void* p) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  countedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  countedFree(p);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+// Counters fed by the global operator new/delete replacements in
+// alloc_counter.cpp. They are per thread, so only the test's own
+// allocations are seen.
+struct AllocCounts
+{
+  std::size_t allocations;
+  std::size_t bytes;
+  std::size_t frees;
+};
+
+AllocCounts currentAllocCounts();
+
+// Counts the allocations, bytes and frees made since construction.
+class AllocScope
+{
+  AllocCounts start_;
+
+public:
+  AllocScope() : start_(currentAllocCounts()) {}
+
+  std::size_t allocations() const
+  {
+    return currentAllocCounts().allocations - start_.allocations;
+  }
+
+  std::size_t bytes() const
+  {
+    return currentAllocCounts().bytes - start_.bytes;
+  }
+
+  std::size_t frees() const
+  {
+    return currentAllocCounts().frees - start_.frees;
+  }
+};
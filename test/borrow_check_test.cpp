@@ -0,0 +1,87 @@
+#include "../borrow_ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+using namespace smrtptrs;
+
+static_assert(SMRTPTRS_CHECKED_BORROWS, "this program is built with borrow checking");
+
+namespace
+{
+
+struct Widget
+{
+  int value;
+};
+
+struct Link
+{
+  shared_ptr<Link> next;
+};
+
+}  // namespace
+
+template <>
+struct smrtptrs::cycle_edges<Link>
+{
+  template <typename F>
+  static void for_each(Link& link, F&& visit)
+  {
+    visit(link.next);
+  }
+};
+
+TEST(BORROW_CHECK_TEST, BorrowsEndingFirstAreFine)
+{
+  auto owner = make_shared<Widget>(Widget{1});
+  {
+    borrow_ptr<Widget> a = owner;
+    borrow_ptr<Widget> b = a;
+    borrow_ptr<Widget> c = std::move(b);
+    c = a;
+    EXPECT_EQ(c->value, 1);
+  }
+  owner.reset();
+  SUCCEED();
+}
+
+TEST(BORROW_CHECK_TEST, OtherOwnersMayGo)
+{
+  auto owner = make_shared<Widget>(Widget{2});
+  auto second = owner;
+  borrow_ptr<Widget> borrowed = second;
+  second.reset();
+  EXPECT_EQ(borrowed->value, 2);
+}
+
+TEST(BORROW_CHECK_TEST, ReleasingLastOwnerWhileBorrowedAborts)
+{
+  EXPECT_DEATH(
+      {
+        auto owner = make_shared<Widget>(Widget{3});
+        borrow_ptr<Widget> borrowed = owner;
+        owner.reset();
+      },
+      "borrow_ptr");
+}
+
+TEST(BORROW_CHECK_TEST, BorrowOfTemporaryAborts)
+{
+  EXPECT_DEATH({ borrow_ptr<Widget> dangling = make_shared<Widget>(Widget{4}); }, "borrow_ptr");
+}
+
+TEST(BORROW_CHECK_TEST, CollectingBorrowedCycleAborts)
+{
+  EXPECT_DEATH(
+      {
+        auto head = make_shared<Link>();
+        head->next = make_shared<Link>();
+        head->next->next = head;
+        borrow_ptr<Link> borrowed = head->next;
+        head.reset();
+        collect_cycles();
+      },
+      "borrow_ptr");
+}
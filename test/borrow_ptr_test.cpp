@@ -0,0 +1,60 @@
+#include "../borrow_ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <type_traits>
+
+using namespace smrtptrs;
+
+namespace
+{
+
+struct Widget
+{
+  int value;
+};
+
+int Value(borrow_ptr<Widget> widget)
+{
+  return widget->value;
+}
+
+}  // namespace
+
+TEST(BORROW_TEST, BorrowsWithoutCounting)
+{
+  auto owner = make_shared<Widget>(Widget{7});
+  EXPECT_EQ(Value(owner), 7);
+  EXPECT_EQ(owner.use_count(), 1u);
+
+  borrow_ptr<Widget> borrowed = owner;
+  auto copy = borrowed;
+  EXPECT_EQ(copy.get(), owner.get());
+  EXPECT_EQ(&*copy, owner.get());
+  EXPECT_EQ(owner.use_count(), 1u);
+}
+
+TEST(BORROW_TEST, NullBorrow)
+{
+  borrow_ptr<Widget> empty;
+  EXPECT_FALSE(empty);
+  EXPECT_TRUE(empty == nullptr);
+
+  shared_ptr<Widget> no_owner;
+  borrow_ptr<Widget> from_empty = no_owner;
+  EXPECT_EQ(from_empty, empty);
+  if constexpr (access_policy::throws)
+  {
+    EXPECT_THROW(*from_empty, std::runtime_error);
+  }
+}
+
+TEST(BORROW_TEST, UncheckedBorrowIsAPointer)
+{
+#if !SMRTPTRS_CHECKED_BORROWS
+  static_assert(sizeof(borrow_ptr<Widget>) == sizeof(Widget*));
+  static_assert(std::is_trivially_copyable<borrow_ptr<Widget>>::value);
+#endif
+  SUCCEED();
+}
@@ -0,0 +1,76 @@
+# Compiles access_codegen.cpp to x86-64 assembly under each access policy
+# and checks the dereference functions:
+#   unchecked_access and asserted_access with NDEBUG: no branch, no call
+#   checked_access: throws, so a branch and __cxa_throw must be present
+#
+# Usage: cmake -DCXX=<compiler> -DSOURCE=<file> -DOUTPUT_DIR=<dir> -P CheckAccessCodegen.cmake
+
+set(FUNCTIONS
+  codegen_unique_deref
+  codegen_unique_arrow
+  codegen_shared_deref
+  codegen_shared_arrow)
+
+function(compile_to_asm name out_var)
+  set(asm "${OUTPUT_DIR}/access_codegen_${name}.s")
+  execute_process(
+    COMMAND ${CXX} -std=c++20 -O2 -S -fno-asynchronous-unwind-tables ${ARGN} "${SOURCE}" -o "${asm}"
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Compiling ${SOURCE} for ${name} failed:\n${errors}")
+  endif()
+  file(STRINGS "${asm}" lines)
+  set(${out_var} "${lines}" PARENT_SCOPE)
+endfunction()
+
+# Collects the instructions between "<function>:" and its ".size" directive.
+function(function_body lines function out_var)
+  set(body)
+  set(inside FALSE)
+  foreach(line IN LISTS lines)
+    if(line STREQUAL "${function}:")
+      set(inside TRUE)
+    elseif(inside AND line MATCHES "^[ \t]*\\.size[ \t]+${function},")
+      break()
+    elseif(inside)
+      list(APPEND body "${line}")
+    endif()
+  endforeach()
+  if(NOT body)
+    message(FATAL_ERROR "${function} not found in the generated assembly")
+  endif()
+  set(${out_var} "${body}" PARENT_SCOPE)
+endfunction()
+
+function(expect_single_path name)
+  compile_to_asm(${name} lines ${ARGN})
+  foreach(function IN LISTS FUNCTIONS)
+    function_body("${lines}" ${function} body)
+    foreach(line IN LISTS body)
+      if(line MATCHES "^[ \t]+(j[a-ln-z][a-z]*|call|jmp)[ \t]")
+        message(FATAL_ERROR "${name}: ${function} should not branch or call, found '${line}'")
+      endif()
+    endforeach()
+  endforeach()
+  message(STATUS "${name}: dereference compiles without branches")
+endfunction()
+
+function(expect_throwing name)
+  compile_to_asm(${name} lines ${ARGN})
+  string(FIND "${lines}" "__cxa_throw" throw_pos)
+  if(throw_pos EQUAL -1)
+    message(FATAL_ERROR "${name}: expected a throwing null check")
+  endif()
+  foreach(function IN LISTS FUNCTIONS)
+    function_body("${lines}" ${function} body)
+    if(NOT body MATCHES "(^|;)[ \t]+j[a-ln-z][a-z]*[ \t]")
+      message(FATAL_ERROR "${name}: ${function} should test for null")
+    endif()
+  endforeach()
+  message(STATUS "${name}: dereference is null checked")
+endfunction()
+
+expect_single_path(unchecked -DSMRTPTRS_UNCHECKED_ACCESS)
+expect_single_path(asserted_ndebug -DSMRTPTRS_ASSERTED_ACCESS -DNDEBUG)
+expect_throwing(checked)
@@ -0,0 +1,29 @@
+// Compiled to assembly by CheckAccessCodegen.cmake under each access
+// policy; the extern "C" functions are looked up by name in the output.
+#include "../../shared_ptr.h"
+#include "../../unique_ptr.h"
+
+struct Payload
+{
+  int value;
+};
+
+extern "C" int codegen_unique_deref(const smrtptrs::unique_ptr<Payload>& p)
+{
+  return (*p).value;
+}
+
+extern "C" int codegen_unique_arrow(const smrtptrs::unique_ptr<Payload>& p)
+{
+  return p->value;
+}
+
+extern "C" int codegen_shared_deref(const smrtptrs::shared_ptr<Payload>& p)
+{
+  return (*p).value;
+}
+
+extern "C" int codegen_shared_arrow(const smrtptrs::shared_ptr<Payload>& p)
+{
+  return p->value;
+}
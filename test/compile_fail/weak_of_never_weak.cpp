@@ -0,0 +1,19 @@
+// Must not compile: weak_ptr of a type that opted out of weak counting.
+#include "../../weak_ptr.h"
+
+struct NeverWeak
+{
+  int value;
+};
+
+template <>
+struct smrtptrs::weak_observable<NeverWeak> : std::false_type
+{
+};
+
+int main()
+{
+  smrtptrs::shared_ptr<NeverWeak> shared(new NeverWeak{1});
+  smrtptrs::weak_ptr<NeverWeak> weak(shared);
+  return weak.expired() ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+#include "../copy_tracking.h"
+#include "../shared_ptr.h"
+#include "../weak_ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "my_res.h"
+
+using namespace smrtptrs;
+
+namespace
+{
+
+struct COPY_TRACKING_TEST : ::testing::Test
+{
+  void SetUp() override
+  {
+    report_copies_at_exit(false);
+    reset_copy_sites();
+  }
+};
+
+std::size_t CountAt(std::uint_least32_t line)
+{
+  std::size_t count = 0;
+  for (const auto& site : copy_sites())
+  {
+    if (site.line == line)
+    {
+      count += site.count;
+    }
+  }
+  return count;
+}
+
+void TakeByValue(shared_ptr<MyRes>) {}
+
+}  // namespace
+
+TEST_F(COPY_TRACKING_TEST, CopyConstructionIsRecordedAtTheCaller)
+{
+  auto p = make_shared<MyRes>(1);
+  std::uint_least32_t line = __LINE__ + 1;
+  shared_ptr<MyRes> q(p);
+  std::uint_least32_t loop_line = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    loop_line = __LINE__ + 1;
+    TakeByValue(p);
+  }
+
+  auto sites = copy_sites();
+  ASSERT_EQ(sites.size(), 2u);
+  EXPECT_EQ(sites[0].count, 3u);
+  EXPECT_EQ(sites[0].line, loop_line);
+  EXPECT_EQ(sites[0].kind, copy_kind::copy);
+  EXPECT_EQ(sites[0].type, "MyRes");
+  EXPECT_EQ(sites[1].count, 1u);
+  EXPECT_EQ(sites[1].line, line);
+  EXPECT_NE(std::string(sites[1].file).find("copy_tracking_test.cpp"), std::string::npos);
+}
+
+TEST_F(COPY_TRACKING_TEST, CopyAssignmentIsRecordedAtTheCaller)
+{
+  auto p = make_shared<MyRes>(1);
+  shared_ptr<MyRes> q;
+  std::uint_least32_t line = __LINE__ + 1;
+  q = p;
+  EXPECT_EQ(p.use_count(), 2u);
+  EXPECT_EQ(CountAt(line), 1u);
+
+  q = q;
+  EXPECT_EQ(p.use_count(), 2u);
+}
+
+TEST_F(COPY_TRACKING_TEST, MovesAndEmptyCopiesAreNotRecorded)
+{
+  auto p = make_shared<MyRes>(1);
+  shared_ptr<MyRes> q(std::move(p));
+  p = std::move(q);
+  shared_ptr<MyRes> empty;
+  shared_ptr<MyRes> copy(empty);
+  EXPECT_TRUE(copy_sites().empty());
+}
+
+TEST_F(COPY_TRACKING_TEST, LockIsRecorded)
+{
+  auto p = make_shared<MyRes>(1);
+  weak_ptr<MyRes> w(p);
+  std::uint_least32_t line = __LINE__ + 1;
+  auto locked = w.lock();
+
+  auto sites = copy_sites();
+  ASSERT_EQ(sites.size(), 1u);
+  EXPECT_EQ(sites[0].kind, copy_kind::lock);
+  EXPECT_EQ(sites[0].line, line);
+  EXPECT_EQ(p.use_count(), 2u);
+}
+
+TEST_F(COPY_TRACKING_TEST, ReportIsSortedByCopies)
+{
+  auto a = make_shared<int>(1);
+  auto b = make_shared<MyRes>(2);
+  shared_ptr<MyRes> b1(b);
+  for (int i = 0; i < 5; ++i)
+  {
+    shared_ptr<int> a1(a);
+  }
+
+  std::ostringstream os;
+  report_copies(os);
+  std::string report = os.str();
+  EXPECT_NE(report.find("6 strong references added at 2 call sites"), std::string::npos);
+
+  auto int_site = report.find("[int]");
+  auto res_site = report.find("[MyRes]");
+  ASSERT_NE(int_site, std::string::npos);
+  ASSERT_NE(res_site, std::string::npos);
+  EXPECT_LT(int_site, res_site);
+  EXPECT_NE(report.find("per type:"), std::string::npos);
+}
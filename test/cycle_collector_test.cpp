@@ -0,0 +1,258 @@
+#include "../shared_ptr.h"
+#include "../weak_ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace smrtptrs;
+
+namespace
+{
+
+struct Node
+{
+  static inline int alive = 0;
+  // calls of cycle_edges<Node>::for_each, one per object visited
+  static inline int visits = 0;
+
+  shared_ptr<Node> next;
+  std::vector<shared_ptr<Node>> children;
+
+  Node()
+  {
+    ++alive;
+  }
+
+  ~Node()
+  {
+    --alive;
+  }
+};
+
+struct Plain
+{
+  shared_ptr<Plain> next;
+};
+
+}  // namespace
+
+template <>
+struct smrtptrs::cycle_edges<Node>
+{
+  template <typename F>
+  static void for_each(Node& node, F&& visit)
+  {
+    ++Node::visits;
+    visit(node.next);
+    for (auto& child : node.children)
+    {
+      visit(child);
+    }
+  }
+};
+
+namespace
+{
+
+struct CYCLE_COLLECTOR_TEST : ::testing::Test
+{
+  void SetUp() override
+  {
+    collect_cycles();
+    Node::alive = 0;
+  }
+
+  void TearDown() override
+  {
+    collect_cycles();
+    EXPECT_EQ(pending_cycle_roots(), 0u);
+  }
+};
+
+// a -> b -> ... -> a, with no owner outside the ring
+void MakeRing(int length)
+{
+  auto first = make_shared<Node>();
+  auto last = first;
+  for (int i = 1; i < length; ++i)
+  {
+    last->next = make_shared<Node>();
+    last = last->next;
+  }
+  last->next = first;
+}
+
+}  // namespace
+
+TEST_F(CYCLE_COLLECTOR_TEST, TraitSelectsTracedTypes)
+{
+  static_assert(cycle_traced_v<Node>);
+  static_assert(!cycle_traced_v<Plain>);
+  static_assert(!cycle_traced_v<int>);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, UnreachableRingIsReclaimed)
+{
+  MakeRing(2);
+  EXPECT_EQ(Node::alive, 2);
+  EXPECT_GT(pending_cycle_roots(), 0u);
+
+  EXPECT_EQ(collect_cycles(), 2u);
+  EXPECT_EQ(Node::alive, 0);
+  EXPECT_EQ(pending_cycle_roots(), 0u);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, SelfLoopIsReclaimed)
+{
+  {
+    auto node = make_shared<Node>();
+    node->next = node;
+  }
+  EXPECT_EQ(Node::alive, 1);
+  EXPECT_EQ(collect_cycles(), 1u);
+  EXPECT_EQ(Node::alive, 0);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, ReachableRingIsKept)
+{
+  auto a = make_shared<Node>();
+  a->next = make_shared<Node>();
+  a->next->next = a;
+  shared_ptr<Node> b = a->next;
+  b.reset();
+
+  EXPECT_EQ(collect_cycles(), 0u);
+  EXPECT_EQ(Node::alive, 2);
+  EXPECT_EQ(a.use_count(), 2u);
+  EXPECT_EQ(a->next.use_count(), 1u);
+
+  a.reset();
+  EXPECT_EQ(collect_cycles(), 2u);
+  EXPECT_EQ(Node::alive, 0);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, LiveObjectsReferencedByGarbageSurvive)
+{
+  auto survivor = make_shared<Node>();
+  {
+    auto a = make_shared<Node>();
+    a->next = make_shared<Node>();
+    a->next->next = a;
+    a->children.push_back(survivor);
+    a->next->children.push_back(survivor);
+  }
+  EXPECT_EQ(survivor.use_count(), 3u);
+
+  EXPECT_EQ(collect_cycles(), 2u);
+  EXPECT_EQ(Node::alive, 1);
+  EXPECT_EQ(survivor.use_count(), 1u);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, WeakPtrToCollectedObjectExpires)
+{
+  weak_ptr<Node> observer;
+  {
+    auto node = make_shared<Node>();
+    node->next = node;
+    observer = weak_ptr<Node>(node);
+  }
+  EXPECT_FALSE(observer.expired());
+
+  collect_cycles();
+  EXPECT_TRUE(observer.expired());
+  EXPECT_EQ(Node::alive, 0);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, StepsAreBoundedByBudget)
+{
+  for (int i = 0; i < 100; ++i)
+  {
+    MakeRing(4);
+  }
+  EXPECT_EQ(Node::alive, 400);
+
+  std::size_t reclaimed = 0;
+  int steps = 0;
+  while (pending_cycle_roots() > 0)
+  {
+    std::size_t freed = collect_cycles_step(8);
+    EXPECT_LE(freed, 8u);
+    reclaimed += freed;
+    ++steps;
+  }
+  EXPECT_EQ(reclaimed, 400u);
+  EXPECT_GE(steps, 50);
+  EXPECT_EQ(Node::alive, 0);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, LargeLiveGraphIsTracedAcrossSteps)
+{
+  constexpr int size = 10000;
+  auto head = make_shared<Node>();
+  auto last = head;
+  for (int i = 1; i < size; ++i)
+  {
+    last->children.push_back(make_shared<Node>());
+    last = last->children.back();
+  }
+  last->next = head;
+  last.reset();
+  EXPECT_GT(pending_cycle_roots(), 0u);
+
+  int steps = 0;
+  while (pending_cycle_roots() > 0)
+  {
+    Node::visits = 0;
+    EXPECT_EQ(collect_cycles_step(1), 0u);
+    ASSERT_LE(Node::visits, 1);
+    ++steps;
+  }
+  // traced, then scanned, one object per step
+  EXPECT_GE(steps, 2 * size);
+  EXPECT_EQ(Node::alive, size);
+
+  head.reset();
+  EXPECT_EQ(collect_cycles(), static_cast<std::size_t>(size));
+  EXPECT_EQ(Node::alive, 0);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, OwnersChangingBetweenStepsAreSeen)
+{
+  auto a = make_shared<Node>();
+  a->next = make_shared<Node>();
+  a->next->next = make_shared<Node>();
+  a->next->next->next = a;
+  {
+    auto copy = a->next;
+  }
+  ASSERT_EQ(pending_cycle_roots(), 1u);
+
+  // takes the root, then visits it, which counts the edge into the third node
+  collect_cycles_step(1);
+  collect_cycles_step(1);
+
+  // the only outside owner moves to the third node, after its edge was counted
+  shared_ptr<Node> b = a->next->next;
+  a.reset();
+  while (pending_cycle_roots() > 0)
+  {
+    EXPECT_EQ(collect_cycles_step(1), 0u);
+  }
+  EXPECT_EQ(Node::alive, 3);
+  EXPECT_EQ(b->next->next->next, b);
+
+  weak_ptr<Node> observer(b);
+  b.reset();
+  EXPECT_EQ(collect_cycles(), 3u);
+  EXPECT_TRUE(observer.expired());
+  EXPECT_EQ(Node::alive, 0);
+}
+
+TEST_F(CYCLE_COLLECTOR_TEST, UntracedTypesAreNotBuffered)
+{
+  auto a = make_shared<Plain>();
+  auto b = a;
+  b.reset();
+  EXPECT_EQ(pending_cycle_roots(), 0u);
+}
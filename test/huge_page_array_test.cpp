@@ -0,0 +1,99 @@
+#include "../huge_page_array.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <limits>
+
+using namespace smrtptrs;
+
+namespace
+{
+
+std::atomic<int> live_cells{0};
+std::atomic<int> constructed_cells{0};
+std::atomic<int> throw_at{-1};
+
+struct Cell
+{
+  int value;
+
+  Cell() : value(7)
+  {
+    if (constructed_cells.fetch_add(1) == throw_at.load())
+    {
+      throw std::runtime_error("Cell construction failed");
+    }
+    ++live_cells;
+  }
+
+  ~Cell()
+  {
+    --live_cells;
+  }
+};
+
+}  // namespace
+
+TEST(HUGE_PAGE_TEST, ValueInitializedAndAligned)
+{
+  constexpr std::size_t size = (huge_page_size / sizeof(int)) * 3 + 5;
+  auto arr = make_unique_huge<int[]>(size, 4);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(arr.get()) % huge_page_size, 0u);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    ASSERT_EQ(arr[i], 0);
+  }
+  arr[size - 1] = 3;
+  EXPECT_EQ(arr.get_deleter().size, size);
+}
+
+TEST(HUGE_PAGE_TEST, ElementsConstructedAndDestroyed)
+{
+  constexpr std::size_t size = huge_page_size / sizeof(Cell) * 2 + 1;
+  {
+    auto arr = make_unique_huge<Cell[]>(size, 3);
+    EXPECT_EQ(live_cells.load(), static_cast<int>(size));
+    EXPECT_EQ(arr[size - 1].value, 7);
+
+    auto moved = std::move(arr);
+    EXPECT_EQ(moved[0].value, 7);
+  }
+  EXPECT_EQ(live_cells.load(), 0);
+}
+
+TEST(HUGE_PAGE_TEST, SharedArray)
+{
+  constexpr std::size_t size = 1000;
+  {
+    auto arr = make_shared_huge<Cell[]>(size, 2);
+    auto copy = arr;
+    EXPECT_EQ(copy.use_count(), 2u);
+    EXPECT_EQ(arr[999].value, 7);
+    EXPECT_EQ(live_cells.load(), static_cast<int>(size));
+  }
+  EXPECT_EQ(live_cells.load(), 0);
+}
+
+TEST(HUGE_PAGE_TEST, ThrowingElementUnwindsEverything)
+{
+  constexpr std::size_t size = huge_page_size / sizeof(Cell) * 4;
+  constructed_cells = 0;
+  throw_at = static_cast<int>(size / 2);
+  EXPECT_THROW(make_unique_huge<Cell[]>(size, 4), std::runtime_error);
+  throw_at = -1;
+  EXPECT_EQ(live_cells.load(), 0);
+}
+
+TEST(HUGE_PAGE_TEST, OversizedArrayThrows)
+{
+  EXPECT_THROW(make_unique_huge<Cell[]>(std::numeric_limits<std::size_t>::max() / sizeof(Cell)), std::bad_array_new_length);
+  EXPECT_THROW(make_shared_huge<int[]>(std::numeric_limits<std::size_t>::max()), std::bad_array_new_length);
+  EXPECT_EQ(live_cells.load(), 0);
+}
+
+TEST(HUGE_PAGE_TEST, EmptyArray)
+{
+  auto arr = make_unique_huge<int[]>(0);
+  EXPECT_FALSE(arr);
+}
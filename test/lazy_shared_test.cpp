@@ -0,0 +1,159 @@
+#include "../lazy_shared.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace smrtptrs;
+
+namespace
+{
+
+struct Component
+{
+  static inline std::atomic<int> built = 0;
+  static inline std::atomic<int> destroyed = 0;
+
+  std::string name;
+
+  explicit Component(std::string n) : name(std::move(n))
+  {
+    ++built;
+  }
+
+  ~Component()
+  {
+    ++destroyed;
+  }
+};
+
+struct LAZY_SHARED_TEST : ::testing::Test
+{
+  void SetUp() override
+  {
+    Component::built = 0;
+    Component::destroyed = 0;
+  }
+};
+
+}  // namespace
+
+TEST_F(LAZY_SHARED_TEST, BuildsOnFirstAccess)
+{
+  auto lazy = make_lazy_shared<Component>("db");
+  EXPECT_TRUE(lazy);
+  EXPECT_FALSE(lazy.constructed());
+  EXPECT_EQ(Component::built, 0);
+
+  EXPECT_EQ(lazy->name, "db");
+  EXPECT_TRUE(lazy.constructed());
+  EXPECT_EQ((*lazy).name, "db");
+  EXPECT_EQ(lazy.get(), lazy.get());
+  EXPECT_EQ(Component::built, 1);
+}
+
+TEST_F(LAZY_SHARED_TEST, CopiesShareOneObject)
+{
+  auto lazy = make_lazy_shared<Component>("cache");
+  auto copy = lazy;
+  EXPECT_EQ(lazy.use_count(), 2u);
+
+  EXPECT_EQ(copy.get(), lazy.get());
+  EXPECT_TRUE(lazy.constructed());
+  EXPECT_EQ(Component::built, 1);
+
+  lazy = lazy_shared<Component>();
+  EXPECT_EQ(Component::destroyed, 0);
+  copy = lazy;
+  EXPECT_EQ(Component::destroyed, 1);
+}
+
+TEST_F(LAZY_SHARED_TEST, NeverUsedObjectIsNeverBuilt)
+{
+  {
+    auto lazy = make_lazy_shared<Component>("unused");
+    auto copy = lazy;
+  }
+  EXPECT_EQ(Component::built, 0);
+  EXPECT_EQ(Component::destroyed, 0);
+}
+
+TEST_F(LAZY_SHARED_TEST, EmptyLazySharedYieldsNull)
+{
+  lazy_shared<Component> empty;
+  EXPECT_FALSE(empty);
+  EXPECT_EQ(empty.get(), nullptr);
+  EXPECT_THROW(*empty, std::runtime_error);
+}
+
+TEST_F(LAZY_SHARED_TEST, FactoryRunsOnceAcrossThreads)
+{
+  std::atomic<int> calls = 0;
+  lazy_shared<Component> lazy(
+      [&calls](void* storage)
+      {
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ::new (storage) Component("shared");
+      });
+
+  std::vector<std::thread> threads;
+  std::vector<Component*> seen(8);
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back([&lazy, &seen, i] { seen[i] = lazy.get(); });
+  }
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+
+  EXPECT_EQ(calls, 1);
+  for (auto* p : seen)
+  {
+    EXPECT_EQ(p, lazy.get());
+  }
+}
+
+TEST_F(LAZY_SHARED_TEST, ThrowingFactoryIsRetried)
+{
+  int attempts = 0;
+  lazy_shared<Component> lazy(
+      [&attempts](void* storage)
+      {
+        if (++attempts == 1)
+        {
+          throw std::runtime_error("not yet");
+        }
+        ::new (storage) Component("second try");
+      });
+
+  EXPECT_THROW(lazy.get(), std::runtime_error);
+  EXPECT_FALSE(lazy.constructed());
+  EXPECT_EQ(lazy->name, "second try");
+  EXPECT_EQ(attempts, 2);
+}
+
+TEST_F(LAZY_SHARED_TEST, WeakPtrObservesWithoutBuilding)
+{
+  auto lazy = make_lazy_shared<Component>("observed");
+  lazy_shared<Component>::weak_type weak = lazy;
+  EXPECT_FALSE(weak.expired());
+  EXPECT_EQ(weak.getPtr(), nullptr);
+  EXPECT_FALSE(weak.lock());
+  EXPECT_EQ(Component::built, 0);
+
+  auto owner = lazy.share();
+  EXPECT_EQ(Component::built, 1);
+  EXPECT_EQ(weak.lock()->name, "observed");
+
+  lazy = lazy_shared<Component>();
+  owner.reset();
+  EXPECT_TRUE(weak.expired());
+  EXPECT_EQ(Component::destroyed, 1);
+}
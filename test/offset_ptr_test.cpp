@@ -0,0 +1,173 @@
+#include "../offset_ptr.h"
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+
+#include <cstring>
+#include <string>
+
+#include "../offset_shared_ptr.h"
+#include "../offset_unique_ptr.h"
+#include "../shm_mapping.h"
+#include "alloc_counter.h"
+
+using namespace smrtptrs;
+
+namespace
+{
+
+constexpr std::size_t segment_size = 1 << 16;
+
+struct Node
+{
+  int value;
+  offset_shared_ptr<Node> next;
+  offset_unique_ptr<int> payload;
+
+  explicit Node(int v) : value(v), next(), payload() {}
+};
+
+struct Graph
+{
+  offset_shared_ptr<Node> head;
+  offset_shared_ptr<Node> extra_owner;
+};
+
+struct alignas(16) Buffer
+{
+  unsigned char bytes[segment_size];
+};
+
+}  // namespace
+
+TEST(OFFSET_TEST, OffsetPtrSurvivesRelocation)
+{
+  struct SelfRef
+  {
+    int value;
+    offset_ptr<int> self;
+  };
+
+  alignas(SelfRef) unsigned char first[sizeof(SelfRef)];
+  alignas(SelfRef) unsigned char second[sizeof(SelfRef)];
+  auto* a = ::new (first) SelfRef{42, nullptr};
+  a->self = &a->value;
+  std::memcpy(second, first, sizeof(SelfRef));
+
+  // the copy points into itself, not back into the original
+  auto* b = std::launder(reinterpret_cast<SelfRef*>(second));
+  EXPECT_EQ(b->self.get(), &b->value);
+  EXPECT_EQ(*b->self, 42);
+
+  offset_ptr<int> empty;
+  EXPECT_FALSE(empty);
+  EXPECT_EQ(empty.get(), nullptr);
+  EXPECT_TRUE(empty == nullptr);
+}
+
+TEST(OFFSET_TEST, SegmentReusesFreedChunks)
+{
+  auto buffer = std::make_unique<Buffer>();
+  segment* seg = segment::create(buffer->bytes, segment_size);
+
+  void* p1 = seg->allocate(64);
+  std::size_t used = seg->used();
+  seg->deallocate(p1);
+  void* p2 = seg->allocate(48);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(seg->used(), used);
+  EXPECT_EQ(segment::owner_of(p2), seg);
+
+  EXPECT_THROW(seg->allocate(segment_size), std::bad_alloc);
+  EXPECT_THROW(segment::attach(buffer->bytes + 16), std::runtime_error);
+}
+
+TEST(OFFSET_TEST, SmartPointersDoNotUseTheHeap)
+{
+  auto buffer = std::make_unique<Buffer>();
+  segment* seg = segment::create(buffer->bytes, segment_size);
+
+  AllocScope scope;
+  {
+    auto unique = make_offset_unique<int>(*seg, 5);
+    auto shared = make_offset_shared<Node>(*seg, 6);
+    auto copy = shared;
+    EXPECT_EQ(*unique, 5);
+    EXPECT_EQ(copy->value, 6);
+    EXPECT_EQ(shared.use_count(), 2u);
+  }
+  EXPECT_EQ(scope.allocations(), 0u);
+}
+
+TEST(OFFSET_TEST, TwoMappingsShareOneGraph)
+{
+  int fd = memfd_segment("smrtptrs_offset_test", segment_size);
+  shm_mapping first(fd, segment_size);
+  shm_mapping second(fd, segment_size);
+  ::close(fd);
+  ASSERT_NE(first.data(), second.data());
+
+  segment* writer = segment::create(first.data(), segment_size);
+  auto* graph = writer->construct<Graph>();
+  writer->set_root(graph);
+  graph->head = make_offset_shared<Node>(*writer, 1);
+  graph->head->next = make_offset_shared<Node>(*writer, 2);
+  graph->head->next->payload = make_offset_unique<int>(*writer, 20);
+
+  segment* reader = segment::attach(second.data());
+  auto* seen = reader->root<Graph>();
+  ASSERT_NE(static_cast<void*>(seen), static_cast<void*>(graph));
+  EXPECT_EQ(seen->head->value, 1);
+  EXPECT_EQ(seen->head->next->value, 2);
+  EXPECT_EQ(*seen->head->next->payload, 20);
+
+  // an owner added through one mapping is counted in the other
+  seen->extra_owner = seen->head->next;
+  EXPECT_EQ(graph->head->next.use_count(), 2u);
+
+  std::size_t used = writer->used();
+  graph->head.reset();
+  EXPECT_EQ(seen->extra_owner->value, 2);
+  EXPECT_EQ(seen->extra_owner.use_count(), 1u);
+
+  // freed chunks are handed out again through the other mapping
+  seen->extra_owner.reset();
+  auto reused = make_offset_shared<Node>(*reader, 3);
+  EXPECT_EQ(writer->used(), used);
+  segment::destroy(graph);
+}
+
+TEST(OFFSET_TEST, OwnersAcrossProcesses)
+{
+  std::string name = "/smrtptrs_offset_test_" + std::to_string(::getpid());
+  int fd = shm_segment(name.c_str(), segment_size, true);
+  {
+    shm_mapping mapping(fd, segment_size);
+    segment* seg = segment::create(mapping.data(), segment_size);
+    auto* graph = seg->construct<Graph>();
+    seg->set_root(graph);
+    graph->head = make_offset_shared<Node>(*seg, 7);
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+      // map the object again by name, at whatever address this process picks
+      int child_fd = shm_segment(name.c_str(), 0, false);
+      shm_mapping view(child_fd, segment_size);
+      ::close(child_fd);
+      Graph* shared_graph = segment::attach(view.data())->root<Graph>();
+      shared_graph->extra_owner = shared_graph->head;
+      shared_graph->head->value = 8;
+      ::_exit(shared_graph->head.use_count() == 2 ? 0 : 1);
+    }
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_EQ(graph->head.use_count(), 2u);
+    EXPECT_EQ(graph->extra_owner->value, 8);
+  }
+  ::close(fd);
+  ::shm_unlink(name.c_str());
+}
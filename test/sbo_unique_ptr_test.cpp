@@ -0,0 +1,149 @@
+#include "../sbo_unique_ptr.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "alloc_counter.h"
+
+using namespace smrtptrs;
+
+namespace
+{
+
+int live_shapes = 0;
+
+struct Shape
+{
+  Shape()
+  {
+    ++live_shapes;
+  }
+  Shape(const Shape&)
+  {
+    ++live_shapes;
+  }
+  virtual ~Shape()
+  {
+    --live_shapes;
+  }
+  virtual int area() const = 0;
+};
+
+struct Square : Shape
+{
+  int side;
+
+  explicit Square(int s) : side(s) {}
+  Square(Square&& other) noexcept : Shape(other), side(other.side)
+  {
+    other.side = 0;
+  }
+
+  int area() const override
+  {
+    return side * side;
+  }
+};
+
+struct BigShape : Shape
+{
+  std::array<int, 32> values{};
+
+  explicit BigShape(int v)
+  {
+    values.fill(v);
+  }
+
+  int area() const override
+  {
+    return values[0] * static_cast<int>(values.size());
+  }
+};
+
+}  // namespace
+
+TEST(SBO_UNIQUE_TEST, SmallObjectsAreInline)
+{
+  static_assert(sbo_unique_ptr<Shape>::fits_inline<Square>);
+  static_assert(!sbo_unique_ptr<Shape>::fits_inline<BigShape>);
+
+  AllocScope scope;
+  {
+    auto sp = make_sbo_unique<Shape, Square>(3);
+    EXPECT_TRUE(sp.is_inline());
+    EXPECT_EQ(sp->area(), 9);
+    EXPECT_EQ((*sp).area(), 9);
+    EXPECT_EQ(live_shapes, 1);
+  }
+  EXPECT_EQ(live_shapes, 0);
+  EXPECT_EQ(scope.allocations(), 0u);
+}
+
+TEST(SBO_UNIQUE_TEST, LargeObjectsGoToHeap)
+{
+  AllocScope scope;
+  {
+    auto sp = make_sbo_unique<Shape, BigShape>(2);
+    EXPECT_FALSE(sp.is_inline());
+    EXPECT_EQ(sp->area(), 64);
+    EXPECT_EQ(scope.allocations(), 1u);
+  }
+  EXPECT_EQ(scope.frees(), 1u);
+  EXPECT_EQ(live_shapes, 0);
+}
+
+TEST(SBO_UNIQUE_TEST, MoveInline)
+{
+  auto sp1 = make_sbo_unique<Shape, Square>(4);
+  sbo_unique_ptr<Shape> sp2(std::move(sp1));
+  EXPECT_FALSE(sp1);
+  EXPECT_TRUE(sp2.is_inline());
+  EXPECT_EQ(sp2->area(), 16);
+  EXPECT_EQ(live_shapes, 1);
+
+  sp1 = make_sbo_unique<Shape, Square>(5);
+  sp1 = std::move(sp2);
+  EXPECT_FALSE(sp2);
+  EXPECT_EQ(sp1->area(), 16);
+  EXPECT_EQ(live_shapes, 1);
+}
+
+TEST(SBO_UNIQUE_TEST, MoveHeapKeepsObject)
+{
+  auto sp1 = make_sbo_unique<Shape, BigShape>(1);
+  Shape* raw = sp1.get();
+
+  AllocScope scope;
+  sbo_unique_ptr<Shape> sp2(std::move(sp1));
+  EXPECT_EQ(sp2.get(), raw);
+  EXPECT_EQ(scope.allocations(), 0u);
+  EXPECT_EQ(live_shapes, 1);
+}
+
+TEST(SBO_UNIQUE_TEST, SwapAndReset)
+{
+  auto sp1 = make_sbo_unique<Shape, Square>(2);
+  auto sp2 = make_sbo_unique<Shape, BigShape>(3);
+  sp1.swap(sp2);
+  EXPECT_EQ(sp1->area(), 96);
+  EXPECT_EQ(sp2->area(), 4);
+  EXPECT_TRUE(sp2.is_inline());
+  EXPECT_EQ(live_shapes, 2);
+
+  sp1.reset();
+  sp2 = nullptr;
+  EXPECT_FALSE(sp1);
+  EXPECT_FALSE(sp2);
+  EXPECT_EQ(live_shapes, 0);
+}
+
+TEST(SBO_UNIQUE_TEST, AdoptHeapPointer)
+{
+  {
+    sbo_unique_ptr<Shape> sp(new Square(6));
+    EXPECT_FALSE(sp.is_inline());
+    EXPECT_EQ(sp->area(), 36);
+  }
+  EXPECT_EQ(live_shapes, 0);
+}
@@ -1,13 +1,45 @@
 #include "../shared_ptr.h"
+#include "../weak_ptr.h"
 
 #include <gtest/gtest.h>
 
+#include "alloc_counter.h"
 #include "my_res.h"
 #include "shared_deleters.h"
 #include "shared_functions.h"
 
 using namespace smrtptrs;
 
+namespace
+{
+
+struct NeverWeak
+{
+  int value;
+};
+
+struct SometimesWeak
+{
+  int value;
+};
+
+struct PerThread
+{
+  int value;
+};
+
+}  // namespace
+
+template <>
+struct smrtptrs::weak_observable<NeverWeak> : std::false_type
+{
+};
+
+template <>
+struct smrtptrs::cache_isolated<PerThread> : std::true_type
+{
+};
+
 TEST(SHARED_TEST, CreateCtor)
 {
   shared_ptr<MyRes> ui0(new MyRes(3));
@@ -165,3 +197,313 @@ TEST(SHARED_TEST, Make_Shared2)
     throw std::runtime_error("Incorrect make_shared behavior (single object).");
   }
 }
+
+TEST(SHARED_TEST, ResetTwice)
+{
+  shared_ptr<int> ptr1(new int(10));
+  shared_ptr<int> ptr2(ptr1);
+  ptr2.reset();
+  ptr2.reset();
+  if (ptr2.get() != nullptr || ptr1.use_count() != 1)
+  {
+    throw std::runtime_error("reset() should release exactly one reference.");
+  }
+}
+
+TEST(SHARED_TEST, ShareN)
+{
+  auto ptr = make_shared<MyRes>(5);
+  {
+    auto owners = ptr.share_n(8);
+    if (owners.size() != 8 || ptr.use_count() != 9)
+    {
+      throw std::runtime_error("Incorrect share_n() reference count.");
+    }
+    for (auto& owner : owners)
+    {
+      if (owner != ptr)
+      {
+        throw std::runtime_error("share_n() handed out a different object.");
+      }
+      owner->use();
+    }
+  }
+  if (ptr.use_count() != 1)
+  {
+    throw std::runtime_error("Incorrect reference count after share_n() owners are gone.");
+  }
+
+  shared_ptr<MyRes> empty;
+  auto empties = empty.share_n(3);
+  if (empties.size() != 3 || empties[0] != nullptr || empty.use_count() != 0)
+  {
+    throw std::runtime_error("share_n() of an empty shared_ptr should hand out empty pointers.");
+  }
+}
+
+TEST(SHARED_TEST, ShareNThrowingOutput)
+{
+  // Stores owners in `sink` and throws on write number `fail_at`.
+  struct throwing_inserter
+  {
+    std::vector<shared_ptr<MyRes>>* sink;
+    std::size_t fail_at;
+
+    throwing_inserter& operator*()
+    {
+      return *this;
+    }
+
+    throwing_inserter& operator++(int)
+    {
+      return *this;
+    }
+
+    throwing_inserter& operator=(shared_ptr<MyRes>&& owner)
+    {
+      if (sink->size() + 1 == fail_at)
+      {
+        throw std::runtime_error("write failed");
+      }
+      sink->push_back(std::move(owner));
+      return *this;
+    }
+  };
+
+  auto ptr = make_shared<MyRes>(5);
+  {
+    std::vector<shared_ptr<MyRes>> owners;
+    bool thrown = false;
+    try
+    {
+      ptr.share_n(10, throwing_inserter{&owners, 3});
+    }
+    catch (const std::runtime_error&)
+    {
+      thrown = true;
+    }
+    if (!thrown || owners.size() != 2 || ptr.use_count() != 3)
+    {
+      throw std::runtime_error("share_n() should take back the owners it did not hand out.");
+    }
+  }
+  if (ptr.use_count() != 1)
+  {
+    throw std::runtime_error("Incorrect reference count after a throwing share_n().");
+  }
+}
+
+TEST(SHARED_TEST, ReleaseAll)
+{
+  auto a = make_shared<int>(1);
+  auto b = make_shared<int>(2);
+  std::vector<shared_ptr<int>> owners;
+  a.share_n(4, std::back_inserter(owners));
+  b.share_n(3, std::back_inserter(owners));
+  owners.emplace_back();
+  owners.push_back(make_shared<int>(3));
+  std::swap(owners[1], owners[5]);
+
+  release_all(std::span(owners));
+
+  for (const auto& owner : owners)
+  {
+    if (owner != nullptr)
+    {
+      throw std::runtime_error("release_all() should leave empty pointers.");
+    }
+  }
+  if (a.use_count() != 1 || b.use_count() != 1 || *a != 1 || *b != 2)
+  {
+    throw std::runtime_error("Incorrect reference count after release_all().");
+  }
+
+  std::vector<shared_ptr<int>> last_owners = b.share_n(2);
+  b.reset();
+  release_all(std::span(last_owners));
+  if (b.use_count() != 0)
+  {
+    throw std::runtime_error("release_all() should destroy the last owners.");
+  }
+}
+
+TEST(SHARED_TEST, MakeSharedAllocations)
+{
+  AllocScope scope;
+  {
+    auto ptr = make_shared<MyRes>(1);
+    // the object and its control block
+    if (scope.allocations() != 2)
+    {
+      throw std::runtime_error("make_shared() should allocate the object and its control block.");
+    }
+  }
+  if (scope.frees() != 2)
+  {
+    throw std::runtime_error("The object and its control block should be freed.");
+  }
+}
+
+TEST(SHARED_TEST, CopyMoveResetDoNotAllocate)
+{
+  auto ptr1 = make_shared<MyRes>(1);
+  auto ptr2 = make_shared<MyRes>(2);
+
+  AllocScope scope;
+  shared_ptr<MyRes> ptr3(ptr1);
+  shared_ptr<MyRes> ptr4(std::move(ptr3));
+  ptr3 = ptr2;
+  ptr2 = std::move(ptr4);
+  ptr4.reset();
+  if (scope.allocations() != 0 || scope.frees() != 0)
+  {
+    throw std::runtime_error("Copy, move and reset of a non-last owner should not allocate or free.");
+  }
+
+  ptr1.reset();
+  if (scope.frees() != 0)
+  {
+    throw std::runtime_error("Releasing a non-last owner should not free.");
+  }
+  ptr2.reset();
+  if (scope.allocations() != 0 || scope.frees() != 2)
+  {
+    throw std::runtime_error("Releasing the last owner should free the object and its control block.");
+  }
+}
+
+TEST(SHARED_TEST, ShareNDoesNotAllocateBlocks)
+{
+  auto ptr = make_shared<int>(1);
+  std::vector<shared_ptr<int>> owners;
+  owners.reserve(16);
+
+  AllocScope scope;
+  ptr.share_n(16, std::back_inserter(owners));
+  release_all(std::span(owners));
+  if (scope.allocations() != 0 || scope.frees() != 0)
+  {
+    throw std::runtime_error("share_n() and release_all() should not allocate or free.");
+  }
+}
+
+TEST(SHARED_TEST, DereferenceNullThrows)
+{
+  shared_ptr<MyRes> ptr;
+  int thrown = 0;
+  try
+  {
+    (void)*ptr;
+  }
+  catch (const std::runtime_error&)
+  {
+    ++thrown;
+  }
+  try
+  {
+    ptr->use();
+  }
+  catch (const std::runtime_error&)
+  {
+    ++thrown;
+  }
+  if (thrown != 2)
+  {
+    throw std::runtime_error("Dereferencing an empty shared_ptr should throw.");
+  }
+}
+
+TEST(SHARED_TEST, WeakCountFreeControlBlock)
+{
+  static_assert(!weak_observable_v<NeverWeak>);
+  static_assert(weak_observable_v<SometimesWeak>);
+
+  std::size_t weak_bytes = 0;
+  {
+    AllocScope scope;
+    auto ptr = make_shared<SometimesWeak>(SometimesWeak{1});
+    weak_bytes = scope.bytes();
+  }
+
+  AllocScope scope;
+  {
+    auto ptr1 = make_shared<NeverWeak>(NeverWeak{2});
+    if (scope.bytes() + sizeof(std::size_t) != weak_bytes)
+    {
+      throw std::runtime_error("The control block should have no weak count.");
+    }
+
+    auto ptr2 = ptr1;
+    if (ptr1.use_count() != 2)
+    {
+      throw std::runtime_error("Incorrect use_count().");
+    }
+    ptr1.reset();
+    if (ptr2->value != 2 || ptr2.use_count() != 1)
+    {
+      throw std::runtime_error("Incorrect use_count() after reset().");
+    }
+
+    auto owners = ptr2.share_n(3);
+    release_all(std::span(owners));
+    if (ptr2.use_count() != 1)
+    {
+      throw std::runtime_error("Incorrect use_count() after release_all().");
+    }
+  }
+  if (scope.frees() != 2 + 1)
+  {
+    throw std::runtime_error("Every allocation should be freed.");
+  }
+}
+
+TEST(SHARED_TEST, ShareNOfNeverWeakNextToWeakPtr)
+{
+  // weak_ptr.h is included here, but weak_ptr<NeverWeak> must not be
+  // instantiated by share_n()
+  auto ptr = make_shared<NeverWeak>(NeverWeak{4});
+  auto owners = ptr.share_n(2);
+  if (ptr.use_count() != 3 || owners[1]->value != 4)
+  {
+    throw std::runtime_error("Incorrect share_n() reference count.");
+  }
+
+  auto observed = make_shared<SometimesWeak>(SometimesWeak{5});
+  weak_ptr<SometimesWeak> weak(observed);
+  if (weak.lock()->value != 5)
+  {
+    throw std::runtime_error("weak_ptr of a weak_observable type should still lock.");
+  }
+}
+
+TEST(SHARED_TEST, CacheIsolatedControlBlock)
+{
+  static_assert(cache_isolated_v<PerThread>);
+  static_assert(!cache_isolated_v<SometimesWeak>);
+
+  AllocScope scope;
+  {
+    auto ptr1 = make_shared<PerThread>(PerThread{3});
+    // counters on one line, pointer and deleter on the next
+    if (scope.bytes() != sizeof(PerThread) + 2 * cache_line_size)
+    {
+      throw std::runtime_error("The counters should have a cache line of their own.");
+    }
+
+    auto ptr2 = ptr1;
+    weak_ptr<PerThread> weak(ptr1);
+    if (ptr1.use_count() != 2)
+    {
+      throw std::runtime_error("Incorrect use_count().");
+    }
+    ptr1.reset();
+    if (weak.lock()->value != 3)
+    {
+      throw std::runtime_error("weak_ptr should still lock the object.");
+    }
+  }
+  if (scope.frees() != 2)
+  {
+    throw std::runtime_error("The object and its control block should be freed.");
+  }
+}
@@ -0,0 +1,110 @@
+#include "../shared_span.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "alloc_counter.h"
+
+using namespace smrtptrs;
+
+namespace
+{
+
+int Sum(std::span<const int> values)
+{
+  return std::accumulate(values.begin(), values.end(), 0);
+}
+
+}  // namespace
+
+TEST(SHARED_SPAN_TEST, ViewsWholeArray)
+{
+  auto span = make_shared_span<int>(4);
+  EXPECT_EQ(span.size(), 4u);
+  EXPECT_EQ(span.size_bytes(), 4 * sizeof(int));
+  EXPECT_EQ(span.use_count(), 1u);
+  for (int v : span)
+  {
+    EXPECT_EQ(v, 0);
+  }
+  std::iota(span.begin(), span.end(), 1);
+  EXPECT_EQ(span[3], 4);
+  EXPECT_EQ(Sum(span), 10);
+}
+
+TEST(SHARED_SPAN_TEST, SliceSharesOwnerWithoutCopying)
+{
+  auto buffer = make_shared_buffer(16);
+  std::memcpy(buffer.data(), "headerpayload!!!", 16);
+
+  AllocScope scope;
+  auto header = buffer.slice(0, 6);
+  auto payload = buffer.slice(6);
+  EXPECT_EQ(scope.allocations(), 0u);
+
+  EXPECT_EQ(header.data(), buffer.data());
+  EXPECT_EQ(payload.data(), buffer.data() + 6);
+  EXPECT_EQ(payload.size(), 10u);
+  EXPECT_EQ(buffer.use_count(), 3u);
+  EXPECT_EQ(std::string_view(header.data(), header.size()), "header");
+
+  auto inner = payload.slice(0, 7);
+  EXPECT_EQ(std::string_view(inner.data(), inner.size()), "payload");
+  EXPECT_EQ(buffer.use_count(), 4u);
+}
+
+TEST(SHARED_SPAN_TEST, SliceKeepsArrayAlive)
+{
+  shared_buffer tail;
+  {
+    auto buffer = make_shared_buffer(8);
+    buffer[7] = 'x';
+    tail = buffer.slice(4, 4);
+  }
+  EXPECT_EQ(tail.use_count(), 1u);
+  EXPECT_EQ(tail[3], 'x');
+}
+
+TEST(SHARED_SPAN_TEST, RvalueSliceMovesReference)
+{
+  auto buffer = make_shared_buffer(8);
+  auto copy = buffer;
+  EXPECT_EQ(buffer.use_count(), 2u);
+
+  auto tail = std::move(copy).slice(2);
+  EXPECT_EQ(buffer.use_count(), 2u);
+  EXPECT_EQ(tail.size(), 6u);
+}
+
+TEST(SHARED_SPAN_TEST, OutOfRangeSliceThrows)
+{
+  auto buffer = make_shared_buffer(8);
+  EXPECT_THROW(buffer.slice(9), std::out_of_range);
+  EXPECT_THROW(buffer.slice(4, 5), std::out_of_range);
+  EXPECT_THROW(buffer.slice(1, SIZE_MAX), std::out_of_range);
+  EXPECT_TRUE(buffer.slice(8).empty());
+
+  // a failed rvalue slice leaves the span and its reference in place
+  auto copy = buffer;
+  EXPECT_THROW(std::move(copy).slice(9), std::out_of_range);
+  EXPECT_EQ(copy.size(), 8u);
+  EXPECT_EQ(buffer.use_count(), 2u);
+}
+
+TEST(SHARED_SPAN_TEST, AdoptsExistingArray)
+{
+  shared_ptr<int[]> owner(new int[3]{1, 2, 3});
+  shared_span<int> span(owner, 3);
+  EXPECT_EQ(owner.use_count(), 2u);
+
+  std::span<int> view = span.slice(1);
+  EXPECT_EQ(view.size(), 2u);
+  EXPECT_EQ(view[0], 2);
+  EXPECT_EQ(Sum(span), 6);
+}
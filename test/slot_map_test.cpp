@@ -0,0 +1,135 @@
+#include "../slot_map.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include "my_res.h"
+
+using namespace smrtptrs;
+
+TEST(SLOT_MAP_TEST, InsertAndGet)
+{
+  slot_map<int> map;
+  auto h1 = map.insert(10);
+  auto h2 = map.emplace(20);
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_TRUE(map.contains(h1));
+  EXPECT_EQ(*map.get(h1), 10);
+  EXPECT_EQ(map[h2], 20);
+
+  map[h2] = 21;
+  EXPECT_EQ(*map.get(h2), 21);
+}
+
+TEST(SLOT_MAP_TEST, EraseMakesHandleStale)
+{
+  slot_map<MyRes> map;
+  auto h1 = map.emplace(1);
+  auto h2 = map.emplace(2);
+  auto h3 = map.emplace(3);
+
+  EXPECT_TRUE(map.erase(h1));
+  EXPECT_FALSE(map.erase(h1));
+  EXPECT_FALSE(map.contains(h1));
+  EXPECT_EQ(map.get(h1), nullptr);
+  EXPECT_THROW(map[h1], std::runtime_error);
+
+  // the last object was moved into the gap; its handle still works
+  map[h2].use();
+  map[h3].use();
+  EXPECT_EQ(map.size(), 2u);
+
+  // the slot is reused, but the old handle stays stale
+  auto h4 = map.emplace(4);
+  EXPECT_EQ(h4.index, h1.index);
+  EXPECT_NE(h4.generation, h1.generation);
+  EXPECT_FALSE(map.contains(h1));
+  map[h4].use();
+}
+
+TEST(SLOT_MAP_TEST, DefaultHandleIsNeverValid)
+{
+  slot_map<int> map;
+  EXPECT_FALSE(map.contains(handle<int>{}));
+  map.insert(5);
+  EXPECT_FALSE(map.contains(handle<int>{}));
+  EXPECT_EQ(map.get(handle<int>{}), nullptr);
+}
+
+TEST(SLOT_MAP_TEST, ThrowingInsertLeavesMapUnchanged)
+{
+  struct Fragile
+  {
+    int value;
+
+    explicit Fragile(int v) : value(v)
+    {
+      if (v < 0)
+      {
+        throw std::runtime_error("Fragile construction failed");
+      }
+    }
+  };
+
+  slot_map<Fragile> map;
+  auto h1 = map.emplace(1);
+  auto h2 = map.emplace(2);
+  map.erase(h1);
+
+  // once with a free slot to reuse, once with none
+  EXPECT_THROW(map.emplace(-1), std::runtime_error);
+  auto h3 = map.emplace(3);
+  EXPECT_EQ(h3.index, h1.index);
+  EXPECT_THROW(map.emplace(-1), std::runtime_error);
+  auto h4 = map.emplace(4);
+
+  EXPECT_EQ(map.size(), 3u);
+  EXPECT_EQ(map[h2].value, 2);
+  EXPECT_EQ(map[h3].value, 3);
+  EXPECT_EQ(map[h4].value, 4);
+  EXPECT_TRUE(map.erase(h2));
+  EXPECT_EQ(map[h4].value, 4);
+}
+
+TEST(SLOT_MAP_TEST, IterationIsDense)
+{
+  slot_map<int> map;
+  std::vector<handle<int>> handles;
+  for (int i = 1; i <= 10; ++i)
+  {
+    handles.push_back(map.insert(i));
+  }
+  for (std::size_t i = 0; i < handles.size(); i += 2)
+  {
+    map.erase(handles[i]);
+  }
+  EXPECT_EQ(std::accumulate(map.begin(), map.end(), 0), 2 + 4 + 6 + 8 + 10);
+  for (std::size_t i = 1; i < handles.size(); i += 2)
+  {
+    EXPECT_EQ(map[handles[i]], static_cast<int>(i) + 1);
+  }
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(handles[1]));
+  auto h = map.insert(42);
+  EXPECT_EQ(map[h], 42);
+}
+
+TEST(SLOT_MAP_TEST, SharedPtrInterop)
+{
+  slot_map<int> map;
+  auto ptr = make_shared<int>(5);
+  auto h = map.insert_shared(ptr);
+  EXPECT_EQ(map[h], 5);
+  EXPECT_EQ(ptr.use_count(), 1u);
+
+  auto extracted = map.extract_shared(h);
+  EXPECT_EQ(*extracted, 5);
+  EXPECT_FALSE(map.contains(h));
+  EXPECT_TRUE(map.empty());
+
+  auto stale = map.extract_shared(h);
+  EXPECT_EQ(stale, nullptr);
+}
@@ -0,0 +1,119 @@
+#include "../tagged_unique_ptr.h"
+
+#include <gtest/gtest.h>
+
+#include "my_res.h"
+
+using namespace smrtptrs;
+
+struct alignas(8) AlignedRes : MyRes
+{
+  using MyRes::MyRes;
+};
+
+struct AlignedResDeleter
+{
+  void operator()(AlignedRes* t)
+  {
+    delete t;
+  }
+};
+
+TEST(TAGGED_UNIQUE_TEST, SameSizeAsRawPointer)
+{
+  static_assert(sizeof(tagged_unique_ptr<AlignedRes, 3>) == sizeof(AlignedRes*));
+  static_assert(sizeof(tagged_unique_ptr<int, 2>) == sizeof(int*));
+}
+
+TEST(TAGGED_UNIQUE_TEST, CreateCtor)
+{
+  tagged_unique_ptr<AlignedRes, 3> tp0(new AlignedRes(3), 5);
+  if (tp0.tag() != 5 || !tp0)
+  {
+    throw std::runtime_error("Incorrect tag after construction.");
+  }
+  tp0->use();
+  (*tp0).use();
+
+  tagged_unique_ptr<AlignedRes, 3> tp1;
+  if (tp1 || tp1.get() != nullptr || tp1.tag() != 0)
+  {
+    throw std::runtime_error("Default constructed tagged_unique_ptr should be empty.");
+  }
+}
+
+TEST(TAGGED_UNIQUE_TEST, SetTagKeepsPointer)
+{
+  auto tp = make_tagged_unique<AlignedRes, 3>(1, 42);
+  AlignedRes* raw = tp.get();
+  for (std::uintptr_t t = 0; t <= tp.tag_mask; ++t)
+  {
+    tp.set_tag(t);
+    if (tp.get() != raw || tp.tag() != t)
+    {
+      throw std::runtime_error("set_tag() changed the stored pointer.");
+    }
+  }
+  tp->use();
+}
+
+TEST(TAGGED_UNIQUE_TEST, MoveAssignment)
+{
+  tagged_unique_ptr<AlignedRes, 2> tp_01(new AlignedRes(10), 2);
+  tagged_unique_ptr<AlignedRes, 2> tp_10(std::move(tp_01));
+  if (tp_01 || tp_10.tag() != 2)
+  {
+    throw std::runtime_error("Incorrect move constructor behavior.");
+  }
+  tp_10->use();
+
+  tp_01 = std::move(tp_10);
+  if (tp_10 || tp_01.tag() != 2)
+  {
+    throw std::runtime_error("Incorrect move assignment behavior.");
+  }
+  tp_01->use();
+}
+
+TEST(TAGGED_UNIQUE_TEST, ReleaseAndReset)
+{
+  tagged_unique_ptr<AlignedRes, 3> tp(new AlignedRes(7), 3);
+  AlignedRes* raw = tp.release();
+  if (tp || tp.tag() != 0 || reinterpret_cast<std::uintptr_t>(raw) % alignof(AlignedRes) != 0)
+  {
+    throw std::runtime_error("release() should return an untagged pointer.");
+  }
+
+  tp.reset(raw, 6);
+  tp.reset(new AlignedRes(8));
+  if (tp.tag() != 6)
+  {
+    throw std::runtime_error("reset() should keep the tag.");
+  }
+  tp->use();
+
+  tp.reset();
+  if (tp)
+  {
+    throw std::runtime_error("Incorrect reset behavior.");
+  }
+}
+
+TEST(TAGGED_UNIQUE_TEST, Swap)
+{
+  tagged_unique_ptr<AlignedRes, 1> tp1(new AlignedRes(1), 1);
+  tagged_unique_ptr<AlignedRes, 1> tp2(new AlignedRes(2), 0);
+  AlignedRes* raw1 = tp1.get();
+  tp1.swap(tp2);
+  if (tp2.get() != raw1 || tp2.tag() != 1 || tp1.tag() != 0)
+  {
+    throw std::runtime_error("Incorrect swap behavior.");
+  }
+}
+
+TEST(TAGGED_UNIQUE_TEST, TaggedDeleters)
+{
+  auto lambda_deleter = [](AlignedRes* t) { delete t; };
+  tagged_unique_ptr<AlignedRes, 3, AlignedResDeleter> tp1(new AlignedRes(15), 7);
+  tagged_unique_ptr<AlignedRes, 3, decltype(lambda_deleter)> tp2(new AlignedRes(14), 4, lambda_deleter);
+}
@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 
+#include "alloc_counter.h"
 #include "my_res.h"
 #include "unique_deleters.h"
 #include "unique_functions.h"
@@ -87,3 +88,133 @@ TEST(UNIQUE_TEST, TestingUniqueArray)
   ui5[4];
   *ui5;
 }
+
+namespace
+{
+
+constexpr int constexpr_make_and_reset()
+{
+  auto ptr = smrtptrs::make_unique<int>(4);
+  *ptr += 1;
+  int before = *ptr;
+  ptr.reset(new int(10));
+  return before + *ptr;
+}
+
+constexpr bool constexpr_release()
+{
+  smrtptrs::unique_ptr<int> ptr(new int(7));
+  int* raw = ptr.release();
+  bool released = !ptr && ptr.get() == nullptr && *raw == 7;
+  smrtptrs::default_delete<int>{}(raw);
+  return released;
+}
+
+constexpr int constexpr_move_and_swap()
+{
+  smrtptrs::unique_ptr<int> ptr1(new int(1));
+  smrtptrs::unique_ptr<int> ptr2(new int(2));
+  ptr1.swap(ptr2);
+  smrtptrs::unique_ptr<int> ptr3(std::move(ptr1));
+  ptr2 = std::move(ptr3);
+  return *ptr2 * 10 + (ptr1 ? 1 : 0) + (ptr3 ? 1 : 0);
+}
+
+// square numbers built at compile time and folded into a constant
+constexpr int constexpr_array_sum(int n)
+{
+  auto squares = smrtptrs::make_unique<int[]>(n);
+  for (int i = 0; i < n; ++i)
+  {
+    squares[i] = i * i;
+  }
+  int sum = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    sum += squares[i];
+  }
+  return sum;
+}
+
+}  // namespace
+
+TEST(UNIQUE_TEST, ConstexprOperations)
+{
+  static_assert(constexpr_make_and_reset() == 15);
+  static_assert(constexpr_release());
+  static_assert(constexpr_move_and_swap() == 20);
+  static_assert(constexpr_array_sum(10) == 285);
+
+  constexpr int table_sum = constexpr_array_sum(100);
+  if (table_sum != constexpr_array_sum(100))
+  {
+    throw std::runtime_error("constexpr and runtime results differ.");
+  }
+}
+
+TEST(UNIQUE_TEST, MakeUniqueAllocatesOnce)
+{
+  AllocScope scope;
+  {
+    auto ui = smrtptrs::make_unique<MyRes>(1);
+    if (scope.allocations() != 1 || scope.bytes() != sizeof(MyRes))
+    {
+      throw std::runtime_error("make_unique() should allocate only the object.");
+    }
+  }
+  if (scope.frees() != 1)
+  {
+    throw std::runtime_error("The object should be freed.");
+  }
+}
+
+TEST(UNIQUE_TEST, MoveSwapResetDoNotAllocate)
+{
+  auto ui1 = smrtptrs::make_unique<MyRes>(1);
+  auto ui2 = smrtptrs::make_unique<MyRes>(2);
+
+  AllocScope scope;
+  smrtptrs::unique_ptr<MyRes> ui3(std::move(ui1));
+  ui1 = std::move(ui2);
+  ui1.swap(ui3);
+  MyRes* raw = ui3.release();
+  ui3.reset(raw);
+  if (scope.allocations() != 0 || scope.frees() != 0)
+  {
+    throw std::runtime_error("Move, swap, release and reset should not allocate or free.");
+  }
+
+  ui3.reset();
+  if (scope.allocations() != 0 || scope.frees() != 1)
+  {
+    throw std::runtime_error("reset() should free only the object.");
+  }
+}
+
+TEST(UNIQUE_TEST, DereferenceNullThrows)
+{
+  static_assert(std::is_same_v<smrtptrs::access_policy, smrtptrs::checked_access>);
+
+  smrtptrs::unique_ptr<MyRes> ui;
+  int thrown = 0;
+  try
+  {
+    (void)*ui;
+  }
+  catch (const std::runtime_error&)
+  {
+    ++thrown;
+  }
+  try
+  {
+    ui->use();
+  }
+  catch (const std::runtime_error&)
+  {
+    ++thrown;
+  }
+  if (thrown != 2)
+  {
+    throw std::runtime_error("Dereferencing an empty unique_ptr should throw.");
+  }
+}
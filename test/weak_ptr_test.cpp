@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include "../shared_ptr.h"
+#include "alloc_counter.h"
 #include "my_res.h"
 
 using namespace smrtptrs;
@@ -49,3 +50,53 @@ TEST(WEAK_TEST, USE_COUNT)
     throw std::runtime_error("Incorrect use_count() after shared_ptr destruction.");
   }
 }
+
+TEST(WEAK_TEST, GetPtrOfEmpty)
+{
+  weak_ptr<MyRes> weak_ptr;
+  if (weak_ptr.getPtr() != nullptr)
+  {
+    throw std::runtime_error("getPtr() of an empty weak_ptr should be nullptr.");
+  }
+}
+
+TEST(WEAK_TEST, CopyAndLockDoNotAllocate)
+{
+  shared_ptr<MyRes> s_ptr(new MyRes(10));
+  weak_ptr<MyRes> weak_ptr1(s_ptr);
+
+  AllocScope scope;
+  {
+    weak_ptr<MyRes> weak_ptr2(weak_ptr1);
+    weak_ptr<MyRes> weak_ptr3(std::move(weak_ptr2));
+    auto locked = weak_ptr3.lock();
+    locked->use();
+    weak_ptr1.swap(weak_ptr3);
+  }
+  if (scope.allocations() != 0 || scope.frees() != 0)
+  {
+    throw std::runtime_error("Copy, move, lock and swap of a weak_ptr should not allocate or free.");
+  }
+}
+
+TEST(WEAK_TEST, ControlBlockFreedAfterLastWeak)
+{
+  AllocScope scope;
+  {
+    weak_ptr<MyRes> weak;
+    {
+      shared_ptr<MyRes> s_ptr(new MyRes(10));
+      weak_ptr<MyRes> observer(s_ptr);
+      weak.swap(observer);
+    }
+    // the object is gone, the control block is kept for the weak_ptr
+    if (scope.frees() != 1)
+    {
+      throw std::runtime_error("The object should be freed before the control block.");
+    }
+  }
+  if (scope.allocations() != 2 || scope.frees() != 2)
+  {
+    throw std::runtime_error("The control block should be freed with the last weak_ptr.");
+  }
+}
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <cstddef>
-#include <iostream>
+#include <type_traits>
+#include <utility>
 
 #include "smrtptrs.h"
 
@@ -18,50 +19,52 @@ public:
 
 private:
   pointer_type ptr_;
-  deleter_type deleter_;
+  [[no_unique_address]] deleter_type deleter_;
 
 public:
-  unique_ptr(pointer_type ptr = nullptr, deleter_type d = deleter_type()) noexcept : ptr_(ptr), deleter_(d) {}
+  constexpr unique_ptr(pointer_type ptr = nullptr, deleter_type d = deleter_type()) noexcept : ptr_(ptr), deleter_(d) {}
 
   template <typename U>
   unique_ptr(U* p, deleter_type d) = delete;
 
-  unique_ptr(unique_ptr&& u) noexcept;
+  constexpr unique_ptr(unique_ptr&& u) noexcept;
 
   // destructor
-  ~unique_ptr();
+  constexpr ~unique_ptr();
 
   // assignment
-  unique_ptr& operator=(unique_ptr&& u) noexcept;
+  constexpr unique_ptr& operator=(unique_ptr&& u) noexcept;
   template <typename U, typename E>
   unique_ptr& operator=(unique_ptr<U, E>&& u) noexcept;
 
-  element_type& operator[](size_t i) const;
-  pointer_type get() const noexcept;
-  deleter_type& get_deleter() noexcept;
-  const deleter_type& get_deleter() const noexcept;
-  explicit operator bool() const noexcept
+  constexpr element_type& operator[](size_t i) const;
+  constexpr pointer_type get() const noexcept;
+  constexpr deleter_type& get_deleter() noexcept;
+  constexpr const deleter_type& get_deleter() const noexcept;
+  constexpr explicit operator bool() const noexcept
   {
     return ptr_ != nullptr;
   }
 
-  element_type operator*() const
+  constexpr element_type& operator*() const noexcept(!access_policy::throws)
   {
+    access_policy::require(ptr_ != nullptr, "Dereferencing null unique_ptr");
     return *ptr_;
   }
-  pointer_type operator->() const
+  constexpr pointer_type operator->() const noexcept(!access_policy::throws)
   {
+    access_policy::require(ptr_ != nullptr, "Dereferencing null unique_ptr");
     return ptr_;
   }
 
-  pointer_type release() noexcept;
-  void reset(pointer_type p = pointer_type()) noexcept;
+  constexpr pointer_type release() noexcept;
+  constexpr void reset(pointer_type p = pointer_type()) noexcept;
 
   template <typename U>
   void reset(U*) = delete;
-  void swap(unique_ptr& u) noexcept;
+  constexpr void swap(unique_ptr& u) noexcept;
 
-  void swap(unique_ptr& first, unique_ptr& second) noexcept;
+  constexpr void swap(unique_ptr& first, unique_ptr& second) noexcept;
 
   // disable copy from lvalue
   unique_ptr(const unique_ptr&) = delete;
@@ -69,7 +72,7 @@ public:
 };
 
 template <typename U, typename E>
-unique_ptr<U, E>::unique_ptr(unique_ptr<U, E>&& u) noexcept : ptr_(u.ptr_),
+constexpr unique_ptr<U, E>::unique_ptr(unique_ptr<U, E>&& u) noexcept : ptr_(u.ptr_),
                                                               deleter_(u.deleter_)
 {
   u.ptr_ = nullptr;
@@ -77,47 +80,47 @@ unique_ptr<U, E>::unique_ptr(unique_ptr<U, E>&& u) noexcept : ptr_(u.ptr_),
 
 // ********* destructor *********
 template <typename U, typename E>
-unique_ptr<U, E>::~unique_ptr()
+constexpr unique_ptr<U, E>::~unique_ptr()
 {
   deleter_(ptr_);
 }
 
 // ********* assignment *********
 template <typename U, typename E>
-unique_ptr<U, E>& unique_ptr<U, E>::operator=(unique_ptr<U, E>&& u) noexcept
+constexpr unique_ptr<U, E>& unique_ptr<U, E>::operator=(unique_ptr<U, E>&& u) noexcept
 {
-  delete this->ptr_;
-  this->ptr_ = nullptr;
+  deleter_(ptr_);
+  ptr_ = nullptr;
   swap(*this, u);
   return *this;
 }
 
 template <typename U, typename E>
-typename unique_ptr<U, E>::element_type& unique_ptr<U, E>::operator[](size_t i) const
+constexpr typename unique_ptr<U, E>::element_type& unique_ptr<U, E>::operator[](size_t i) const
 {
   return ptr_[i];
 }
 
 template <typename U, typename E>
-typename unique_ptr<U, E>::pointer_type unique_ptr<U, E>::get() const noexcept
+constexpr typename unique_ptr<U, E>::pointer_type unique_ptr<U, E>::get() const noexcept
 {
   return ptr_;
 }
 
 template <typename U, typename E>
-typename unique_ptr<U, E>::deleter_type& unique_ptr<U, E>::get_deleter() noexcept
+constexpr typename unique_ptr<U, E>::deleter_type& unique_ptr<U, E>::get_deleter() noexcept
 {
   return deleter_;
 }
 
 template <typename U, typename E>
-const typename unique_ptr<U, E>::deleter_type& unique_ptr<U, E>::get_deleter() const noexcept
+constexpr const typename unique_ptr<U, E>::deleter_type& unique_ptr<U, E>::get_deleter() const noexcept
 {
   return deleter_;
 }
 
 template <typename U, typename E>
-typename unique_ptr<U, E>::pointer_type unique_ptr<U, E>::release() noexcept
+constexpr typename unique_ptr<U, E>::pointer_type unique_ptr<U, E>::release() noexcept
 {
   typename unique_ptr<U, E>::pointer_type ptr = ptr_;
   ptr_ = nullptr;
@@ -125,33 +128,34 @@ typename unique_ptr<U, E>::pointer_type unique_ptr<U, E>::release() noexcept
 }
 
 template <typename U, typename E>
-void unique_ptr<U, E>::reset(typename unique_ptr<U, E>::pointer_type p) noexcept
+constexpr void unique_ptr<U, E>::reset(typename unique_ptr<U, E>::pointer_type p) noexcept
 {
   deleter_(ptr_);
-  ptr(p);
+  ptr_ = p;
 }
 
 template <typename U, typename E>
-void unique_ptr<U, E>::swap(unique_ptr<U, E>& u) noexcept
+constexpr void unique_ptr<U, E>::swap(unique_ptr<U, E>& u) noexcept
 {
   swap(*this, u);
 }
 
 template <typename U, typename E>
-void unique_ptr<U, E>::swap(unique_ptr<U, E>& first, unique_ptr<U, E>& second) noexcept
+constexpr void unique_ptr<U, E>::swap(unique_ptr<U, E>& first, unique_ptr<U, E>& second) noexcept
 {
   std::swap(first.ptr_, second.ptr_);
+  std::swap(first.deleter_, second.deleter_);
 }
 
 // ********* make_unique *********
 template <typename U, typename... Args>
-typename std::enable_if<!std::is_array<U>::value, unique_ptr<U>>::type make_unique(Args&&... args)
+constexpr typename std::enable_if<!std::is_array<U>::value, unique_ptr<U>>::type make_unique(Args&&... args)
 {
   return {new U(std::forward<Args>(args)...)};
 }
 
 template <typename U, typename... Args>
-typename std::enable_if<std::is_array<U>::value, unique_ptr<U>>::type make_unique(size_t size, Args&&... args)
+constexpr typename std::enable_if<std::is_array<U>::value, unique_ptr<U>>::type make_unique(size_t size, Args&&... args)
 {
   using element_type = typename std::remove_extent<U>::type;
   return {new element_type[size]{args...}};
@@ -159,32 +163,32 @@ typename std::enable_if<std::is_array<U>::value, unique_ptr<U>>::type make_uniqu
 
 // ********* comparisons *********
 template <class U, class E>
-inline bool operator==(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
+constexpr bool operator==(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
 {
   return (l.get() == r.get());
 }
 template <class U, class E>
-inline bool operator!=(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
+constexpr bool operator!=(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
 {
   return (l.get() != r.get());
 }
 template <class U, class E>
-inline bool operator<=(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
+constexpr bool operator<=(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
 {
   return (l.get() <= r.get());
 }
 template <class U, class E>
-inline bool operator<(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
+constexpr bool operator<(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
 {
   return (l.get() < r.get());
 }
 template <class U, class E>
-inline bool operator>=(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
+constexpr bool operator>=(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
 {
   return (l.get() >= r.get());
 }
 template <class U, class E>
-inline bool operator>(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
+constexpr bool operator>(const unique_ptr<U>& l, const unique_ptr<E>& r) throw()
 {
   return (l.get() > r.get());
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
 #include "shared_ptr.h"
 
 namespace smrtptrs
@@ -11,6 +15,8 @@ class shared_ptr;
 template <typename T, typename D>
 class weak_ptr
 {
+  static_assert(weak_observable_v<T>, "weak_ptr is disabled for this type by weak_observable<T>");
+
 public:
   using element_type = typename std::conditional<std::is_array<T>::value, typename std::remove_extent<T>::type, T>::type;
   using pointer_type = typename std::conditional<std::is_array<T>::value, element_type*, T*>::type;
@@ -108,7 +114,16 @@ public:
 public:
   bool expired() const
   {
-    return block == nullptr || block->count == 0;
+    if (block == nullptr || block->count == 0)
+    {
+      return true;
+    }
+    // objects the cycle collector is freeing cannot be locked any more
+    if constexpr (cycle_traced_v<T>)
+    {
+      return block->color == detail::cycle_color::garbage;
+    }
+    return false;
   }
 
   explicit operator bool() const
@@ -122,6 +137,17 @@ public:
   }
 
 public:
+#if defined(SMRTPTRS_TRACK_COPIES)
+  shared_ptr<T, D> lock(std::source_location site = std::source_location::current()) const
+  {
+    if (this->expired())
+    {
+      throw std::runtime_error("Trying to lock an expired weak_ptr");
+    }
+    detail::record_copy<T>(copy_kind::lock, site);
+    return shared_ptr<T, D>(*this, true);
+  }
+#else
   shared_ptr<T, D> lock() const
   {
     if (this->expired())
@@ -130,22 +156,18 @@ public:
     }
     return shared_ptr<T, D>(*this, true);
   }
+#endif
 
   void swap(weak_ptr& other) noexcept
   {
     std::swap(block, other.block);
   }
 
-  pointer_type getPtr() const
+  // Not a dereference, so the access policy does not apply: an empty
+  // weak_ptr yields nullptr.
+  pointer_type getPtr() const noexcept
   {
-    if (block)
-    {
-      return block->ptr;
-    }
-    else
-    {
-      return nullptr;
-    }
+    return block ? block->ptr : nullptr;
   }
 };
 